@@ -0,0 +1,108 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+  It measures the time taken by the visitors dispatch when browsing a tree.
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "clefvisitor.h"
+#include "keyvisitor.h"
+#include "notevisitor.h"
+#include "timesignvisitor.h"
+#include "xml.h"
+#include "xmlfile.h"
+#include "xmlreader.h"
+#include "xml_tree_browser.h"
+
+using namespace std;
+using namespace MusicXML2;
+
+//_______________________________________________________________________________
+// a visitor with many visitor<> bases, as typical conversion visitors
+class benchvisitor :
+	public notevisitor,
+	public keyvisitor,
+	public timesignvisitor,
+	public clefvisitor,
+	public visitor<Sxmlelement>
+{
+	public:
+				 benchvisitor() {}
+		virtual ~benchvisitor() {}
+		void visitStart( Sxmlelement& elt )		{}
+};
+
+//_______________________________________________________________________________
+static void usage (const char* name)
+{
+	cerr << "usage: " << name << " [-n count] [-f] file [file...]" << endl;
+	cerr << "       browses each file 'count' times (default 20) and prints the time per visited element" << endl;
+	cerr << "       -f: browses the frozen documents (see TXMLFile::freeze)" << endl;
+	exit (1);
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[])
+{
+	int count = 20;
+	int first = 1;
+	bool frozen = false;
+	if ((argc > first + 1) && (string(argv[first]) == "-n")) {
+		count = atoi(argv[first + 1]);
+		first += 2;
+	}
+	if ((argc > first) && (string(argv[first]) == "-f")) {
+		frozen = true;
+		first++;
+	}
+	if ((first >= argc) || (count <= 0)) usage (argv[0]);
+
+	vector<SXMLFile> files;
+	vector<Sfrozenxml> frozenfiles;
+	long elements = 0;
+	for (int i = first; i < argc; i++) {
+		xmlreader r;
+		SXMLFile file = r.read(argv[i]);
+		if (file && file->elements()) {
+			files.push_back (file);
+			if (frozen) frozenfiles.push_back (file->freeze());
+			Sxmlelement root = file->elements();
+			elements++;
+			for (xmlelement::walker w (root); w != xmlelement::walker(); ++w)
+				elements++;
+		}
+		else cerr << "can't read " << argv[i] << endl;
+	}
+
+	benchvisitor v;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int n = 0; n < count; n++) {
+		for (size_t i = 0; i < files.size(); i++) {
+			if (frozen) {
+				frozen_tree_browser browser(&v, frozenfiles[i]);
+				browser.browse ();
+			}
+			else {
+				xml_tree_browser browser(&v);
+				browser.browse (*files[i]->elements());
+			}
+		}
+	}
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	cout << files.size() << " files (" << elements << " elements) browsed " << count << " times: " << elapsed << " s" << endl;
+	if (elements) cout << "  " << (elapsed * 1e9 / (double(elements) * count)) << " ns per element" << endl;
+	return 0;
+}
@@ -0,0 +1,182 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+  It measures the time taken to serialize the documents, using the xmlwriter
+  (sequentially and using several threads) and using the previous visitor
+  based serialization.
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdlib.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "tree_browser.h"
+#include "typedefs.h"
+#include "visitor.h"
+#include "xml.h"
+#include "xmlescape.h"
+#include "xmlfile.h"
+#include "xmlreader.h"
+#include "xmlwriter.h"
+
+using namespace std;
+using namespace MusicXML2;
+
+//_______________________________________________________________________________
+// the previous serialization, used as reference: a visitor that writes
+// std::endl and the indentation for each element
+class refvisitor :
+	public visitor<S_comment>,
+	public visitor<S_processing_instruction>,
+	public visitor<Sxmlelement>
+{
+	ostream&	fOut;
+	int			fIndent;
+
+	void endl ()	{ fOut << std::endl; for (int i = 0; i < fIndent; i++) fOut << "    "; }
+	void escaped (const string& s, bool attribute) {
+		string e;
+		xmlescape::append (e, s.data(), s.size(), attribute);
+		fOut << e;
+	}
+
+	public:
+				 refvisitor(ostream& stream) : fOut(stream), fIndent(0) {}
+		virtual ~refvisitor() {}
+
+		void visitStart ( S_comment& elt )					{ endl(); fOut << "<!--" << elt->getValue() << "-->"; }
+		void visitStart ( S_processing_instruction& elt )	{ endl(); fOut << "<?" << elt->getValue() << "?>"; }
+		void visitStart ( Sxmlelement& elt ) {
+			endl(); fOut << "<" << elt->getName();
+			for (vector<xmlattribute::slot>::const_iterator a = elt->attributeSlots().begin(); a != elt->attributeSlots().end(); a++)
+				{ fOut << " " << *a->name << "=\""; escaped (a->value, true); fOut << "\""; }
+			if (elt->empty()) fOut << "/>";
+			else {
+				fOut << ">"; escaped (elt->getValue(), false);
+				if (elt->size()) fIndent++;
+			}
+		}
+		void visitEnd ( Sxmlelement& elt ) {
+			if (elt->empty()) return;
+			if (elt->size()) { fIndent--; endl(); }
+			fOut << "</" << elt->getName() << ">";
+		}
+};
+
+static void refprint (const SXMLFile& file, ostream& out)
+{
+	if (file->getXMLDecl()) file->getXMLDecl()->print (out);
+	if (file->getDocType()) file->getDocType()->print (out);
+	refvisitor v(out);
+	tree_browser<xmlelement> browser(&v);
+	browser.browse (*file->elements());
+}
+
+//_______________________________________________________________________________
+enum { kReference, kWriter, kCompact, kThreads };
+
+static unsigned gThreads = 0;
+
+static void print (const SXMLFile& file, ostream& out, int mode)
+{
+	if (mode == kReference) refprint (file, out);
+	else {
+		xmlwriter w(out, mode == kCompact);
+		if (mode == kThreads) w.setThreads (gThreads);
+		w.write (*file);
+	}
+}
+
+//_______________________________________________________________________________
+static double run (const char* name, const vector<SXMLFile>& files, int count, int mode, const char* outfile)
+{
+	size_t size = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int n = 0; n < count; n++) {
+		for (size_t i = 0; i < files.size(); i++) {
+			if (outfile) {
+				ofstream out (outfile);
+				print (files[i], out, mode);
+				size += size_t(out.tellp());
+			}
+			else {
+				ostringstream out;
+				print (files[i], out, mode);
+				size += out.str().size();
+			}
+		}
+	}
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << name << ": " << (size / count) << " bytes in " << (elapsed / count) << " s";
+	if (elapsed > 0) cout << " (" << (double(size) / elapsed / (1024*1024)) << " MB/s)";
+	cout << endl;
+	return elapsed;
+}
+
+//_______________________________________________________________________________
+static void usage (const char* name)
+{
+	cerr << "usage: " << name << " [-n count] [-t threads] [-o outfile] file [file...]" << endl;
+	cerr << "       serializes each file 'count' times (default 10)" << endl;
+	cerr << "       -t: the threads count of the concurrent serialization (default: the hardware threads count)" << endl;
+	cerr << "       -o: writes to 'outfile' (overwritten for each file), the default is to write to memory" << endl;
+	exit (1);
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[])
+{
+	int count = 10;
+	const char* outfile = 0;
+	int first = 1;
+	while ((argc > first + 1) && (argv[first][0] == '-')) {
+		string opt (argv[first]);
+		if (opt == "-n") count = atoi(argv[first + 1]);
+		else if (opt == "-o") outfile = argv[first + 1];
+		else if (opt == "-t") gThreads = atoi(argv[first + 1]);
+		else usage (argv[0]);
+		first += 2;
+	}
+	if ((first >= argc) || (count <= 0)) usage (argv[0]);
+
+	vector<SXMLFile> files;
+	vector<string> names;
+	for (int i = first; i < argc; i++) {
+		xmlreader r;
+		SXMLFile file = r.read(argv[i]);
+		if (file && file->elements()) {
+			files.push_back (file);
+			names.push_back (argv[i]);
+		}
+		else cerr << "can't read " << argv[i] << endl;
+	}
+
+	// checks that the writer outputs are identical to the reference output
+	for (size_t i = 0; i < files.size(); i++) {
+		ostringstream ref, out, threads;
+		print (files[i], ref, kReference);
+		print (files[i], out, kWriter);
+		print (files[i], threads, kThreads);
+		if (ref.str() != out.str()) cerr << "warning: output differs for " << names[i] << endl;
+		if (ref.str() != threads.str()) cerr << "warning: concurrent output differs for " << names[i] << endl;
+	}
+
+	double t1 = run ("visitor          ", files, count, kReference, outfile);
+	double t2 = run ("xmlwriter        ", files, count, kWriter, outfile);
+	double t3 = run ("xmlwriter compact", files, count, kCompact, outfile);
+	double t4 = run ("xmlwriter threads", files, count, kThreads, outfile);
+	if ((t2 > 0) && (t3 > 0) && (t4 > 0))
+		cout << "speedup: " << (t1 / t2) << " (indented), " << (t1 / t3) << " (compact), " << (t1 / t4) << " (threads)" << endl;
+	return 0;
+}
@@ -0,0 +1,130 @@
+/*
+
+  Copyright (C) 2003-2008  Grame
+  Grame Research Laboratory, 9 rue du Garet, 69001 Lyon - France
+  research@grame.fr
+
+  This file is provided as an example of the MusicXML Library use.
+  It measures the rational arithmetic on a typical positions computation:
+  notes durations (including tuplets) are accumulated and compared to the
+  measure length, as done when converting a score.
+*/
+
+#ifdef WIN32
+# pragma warning (disable : 4786)
+#endif
+
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+
+#include "rational.h"
+
+using namespace std;
+
+//_______________________________________________________________________________
+// the previous rational implementation, used as reference: euclid gcd,
+// no normalization of the results and cross products on long ints
+class refrational {
+	long fNum, fDen;
+	static long gcd (long a, long b) {
+		a = labs(a); b = labs(b);
+		while (b > 0) { long r = a % b; a = b; b = r; }
+		return a ? a : 1;
+	}
+	public:
+		refrational (long n = 0, long d = 1) : fNum(n), fDen(d ? d : 1) {}
+		refrational& operator += (const refrational& r) {
+			if (fDen == r.fDen) fNum += r.fNum;
+			else { fNum = fNum * r.fDen + r.fNum * fDen; fDen *= r.fDen; }
+			return *this;
+		}
+		refrational& operator -= (const refrational& r) {
+			if (fDen == r.fDen) fNum -= r.fNum;
+			else { fNum = fNum * r.fDen - r.fNum * fDen; fDen *= r.fDen; }
+			return *this;
+		}
+		refrational& operator *= (const refrational& r)	{ fNum *= r.fNum; fDen *= r.fDen; return *this; }
+		bool operator < (const refrational& r) const	{ return fNum * r.fDen < r.fNum * fDen; }
+		void rationalise ()		{ long g = gcd(fNum, fDen); fNum /= g; fDen /= g; if (!fNum) fDen = 1; }
+		long getNumerator () const		{ return fNum; }
+		long getDenominator () const	{ return fDen; }
+};
+
+//_______________________________________________________________________________
+// the durations of a measure in 4/4: quarters, eighths, triplets, quintuplets and sextuplets
+static const long kDurations[][2] = { {1,4}, {1,8}, {1,8}, {1,4}, {1,16}, {1,16}, {1,8}, {1,4}, {1,12}, {1,12}, {1,12}, {1,20}, {1,20}, {1,20}, {1,20}, {1,20}, {1,24}, {1,24}, {1,24}, {1,24}, {1,24}, {1,24} };
+static const int kCount = sizeof(kDurations) / sizeof(kDurations[0]);
+
+//_______________________________________________________________________________
+// with the previous implementation, the positions must be rationalised after each
+// operation (as done by the converters) to keep the terms small
+template <typename R> static R positions (long measures, bool rationalise, long& notes)
+{
+	R measure (1, 1), total;
+	R tuplet (2, 3);
+	for (long m = 0; m < measures; m++) {
+		R position;
+		for (int i = 0; !(measure < position) && (i < kCount); i++) {
+			R duration (kDurations[i][0], kDurations[i][1]);
+			if (i % 5 == 0) {
+				duration *= tuplet;
+				if (rationalise) duration.rationalise();
+			}
+			position += duration;
+			if (rationalise) position.rationalise();
+			notes++;
+		}
+		total += position;
+		total -= measure;
+		if (rationalise) total.rationalise();
+	}
+	return total;
+}
+
+//_______________________________________________________________________________
+template <typename R> static double run (const char* name, long measures, bool rationalise, R& result)
+{
+	long notes = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	result = positions<R> (measures, rationalise, notes);
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << name << ": " << notes << " notes in " << elapsed << " s (" << (elapsed * 1e9 / notes) << " ns per note), result "
+		 << result.getNumerator() << "/" << result.getDenominator() << endl;
+	return elapsed;
+}
+
+//_______________________________________________________________________________
+// the sum of 1/n for n in [1, count]: the denominators grow quickly
+template <typename R> static R harmonic (int count)
+{
+	R sum;
+	for (int n = 1; n <= count; n++)
+		sum += R(1, n);
+	return sum;
+}
+
+//_______________________________________________________________________________
+int main(int argc, char *argv[])
+{
+	long measures = (argc > 1) ? atol(argv[1]) : 1000000;
+	if (measures <= 0) {
+		cerr << "usage: " << argv[0] << " [measures count]" << endl;
+		return 1;
+	}
+
+	refrational ref;
+	rational cur, normalized;
+	double t1 = run ("previous rational, rationalised", measures, true, ref);
+	double t2 = run ("rational, rationalised         ", measures, true, cur);
+	double t3 = run ("rational, normalized results   ", measures, false, normalized);
+	if (t2 > 0) cout << "speedup: " << (t1 / t2) << " (rationalised), " << (t1 / t3) << " (normalized results)" << endl;
+	if ((ref.getNumerator() != cur.getNumerator()) || (ref.getDenominator() != cur.getDenominator()) || !(cur == normalized))
+		cout << "results differ" << endl;
+
+	refrational h1 = harmonic<refrational> (40);
+	rational h2 = harmonic<rational> (40);
+	cout << "harmonic sum of 40 terms without rationalise: previous rational " << h1.getNumerator() << "/" << h1.getDenominator()
+		 << ", rational " << h2.getNumerator() << "/" << h2.getDenominator() << endl;
+	return 0;
+}
@@ -12,12 +12,12 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include <fstream>
 #ifndef WIN32
 #include <libgen.h>
 #include <signal.h>
-#include <string.h>
 #endif
 
 #include "xml.h"
@@ -39,7 +39,7 @@ static void usage (char* name)
 	cerr << "usage: " << tool << " [options] <musicxml file>" << endl;
 	cerr << "       read a musicxml file and re-write it" << endl;
 	cerr << "       options:" << endl;
-	cerr << "           	-o <file>: output file name" << endl;
+	cerr << "           	-o <file>: output file name, a compressed file is written when it ends with .mxl" << endl;
 	cerr << "       writes to standard output when -o option is missing." << endl;
 	exit(1);
 }
@@ -113,14 +113,23 @@ int main(int argc, char *argv[])
 		usage (argv[0]);
 	const char* filename = getFile (argc, argv);
 
+	size_t len = outfile ? strlen(outfile) : 0;
+	bool compressed = (len > 4) && !strcmp(outfile + len - 4, ".mxl");
+
 	ostream* out;
-	if (outfile)
+	if (outfile && !compressed)
 		out = new ofstream (outfile);
 	else out = &cout;
 
 	xmlreader r;
 	SXMLFile file = r.read(filename);
-	if (file) {
+	if (file && compressed) {
+		if (!file->writeMXL (outfile)) {
+			cerr << "can't write " << outfile << endl;
+			return -1;
+		}
+	}
+	else if (file) {
 //		Sxmlelement st = file->elements();
 		file->print(*out);
 		*out << endl;
@@ -14,8 +14,7 @@
 #define __factory__
 
 #include <string>
-#include <map>
-#include "functor.h"
+#include <vector>
 #include "singleton.h"
 #include "xml.h"
 
@@ -27,16 +26,28 @@ namespace MusicXML2
 @{
 */
 
+//______________________________________________________________________________
+/*!
+\brief creates the MusicXML elements.
+
+	The elements names lookup uses a perfect hash, generated from the MusicXML
+	elements list (see templates/perfecthash.awk).
+*/
 class EXP factory : public singleton<factory>{
 
-	std::map<std::string, functor<Sxmlelement>*> fMap;
-	std::map<int, const char*>	fType2Name;
+	std::vector<nametable::name> fNames;		// the interned elements names, indexed by type
+
 	public:
 				 factory();
 		virtual ~factory() {}
 
 		Sxmlelement create(const std::string& elt) const;	
+		Sxmlelement create(const char* elt) const;	
+		//! creates an element from its type, without names lookup
 		Sxmlelement create(int type) const;	
+		//! gives the type of an element from its name, kNoElement when the name is unknown
+		int			getType(const std::string& elt) const;
+		int			getType(const char* elt) const;
 };
 
 }
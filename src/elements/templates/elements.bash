@@ -29,26 +29,29 @@ case $3 in
 
 
   'map')
-    # copy license and and the factory class preamble
+    # copy license and and the factory preamble
     # to standard output
     cat $2/license.txt $2/factory.txt
 
-    # generate fMap entries for the markups found in the DTD
-   for a in $(cat $1 | cut -d' ' -f1 | sort -u)
+    # generate the elements table, indexed by type
+    echo "static const eltdesc gElements[kEndElement] = {"
+    echo "	{ 0, 0 },"
+    echo "	{ \"comment\", newElement<kComment> },"
+    echo "	{ \"pi\", newElement<kProcessingInstruction> },"
+    for a in $(cat $1 | cut -d' ' -f1 | sort -u)
     do
-      echo "	fMap[\"$a\"] 	= new newElementFunctor<$(kname $a)>;"
+      echo "	{ \"$a\", newElement<$(kname $a)> },"
     done
+    echo "};"
     echo
 
-    # generate fType2Name entries for the markups found in the DTD
-    for a in $(cat $1 | cut -d' ' -f1 | sort -u)
-    do
-      echo "	fType2Name[$(kname $a)] 	= \"$a\";"
-    done
+    # generate the perfect hash tables for the elements names
+    (echo "comment kComment"; echo "pi kProcessingInstruction";
+     for a in $(cat $1 | cut -d' ' -f1 | sort -u); do echo "$a $(kname $a)"; done) \
+      | awk -f $2/perfecthash.awk || exit 1
 
     # generate epiloque
-    echo '}'
-    echo '}'
+    cat $2/factorymethods.txt
     ;;
 
 
@@ -0,0 +1,70 @@
+#
+# generates a perfect hash for the elements names
+# input: one "name type" pair per line
+# output: the hash parameters and tables used by factory::getType
+# the hash function must be kept consistent with hashname in factory.txt
+#
+
+function hashname(s, mult, mod,    h, i) {
+	h = 0
+	for (i = 1; i <= length(s); i++)
+		h = (h * mult + ord[substr(s, i, 1)]) % 4294967296
+	return h % mod
+}
+
+BEGIN {
+	for (i = 32; i < 127; i++) ord[sprintf("%c", i)] = i
+	bucketMult = 31; slotMult = 37
+	bucketsCount = 127; slotsCount = 1021; maxDisp = 1000
+}
+
+{
+	if ($1 in types) { print "duplicated element " $1 > "/dev/stderr"; exit 1 }
+	types[$1] = $2
+	b = hashname($1, bucketMult, bucketsCount)
+	bucket[b, ++bsize[b]] = $1
+	if (bsize[b] > maxsize) maxsize = bsize[b]
+}
+
+END {
+	# place the largest buckets first
+	for (size = maxsize; size > 0; size--) {
+		for (b = 0; b < bucketsCount; b++) {
+			if (bsize[b] != size) continue
+			for (d = 0; d < maxDisp; d++) {
+				ok = 1
+				for (i = 1; ok && (i <= size); i++) {
+					s = hashname(bucket[b, i], slotMult + 2 * d, slotsCount)
+					if ((s in slot) || (s in tmp)) ok = 0
+					tmp[s] = 1
+				}
+				for (s in tmp) delete tmp[s]
+				if (ok) break
+			}
+			if (!ok) { print "can't build the elements perfect hash" > "/dev/stderr"; exit 1 }
+			disp[b] = d
+			for (i = 1; i <= size; i++)
+				slot[hashname(bucket[b, i], slotMult + 2 * d, slotsCount)] = types[bucket[b, i]]
+		}
+	}
+
+	print "enum { kBucketMult = " bucketMult ", kSlotMult = " slotMult ", kBucketsCount = " bucketsCount ", kSlotsCount = " slotsCount " };"
+	print ""
+	print "static const unsigned short gDisplacements[kBucketsCount] = {"
+	line = "	"
+	for (b = 0; b < bucketsCount; b++) {
+		line = line (b in disp ? disp[b] : 0) ((b < bucketsCount - 1) ? "," : "")
+		if ((b % 16 == 15) || (b == bucketsCount - 1)) { print line; line = "	" }
+		else line = line " "
+	}
+	print "};"
+	print ""
+	print "static const unsigned short gSlots[kSlotsCount] = {"
+	line = "	"
+	for (s = 0; s < slotsCount; s++) {
+		line = line (s in slot ? slot[s] : 0) ((s < slotsCount - 1) ? "," : "")
+		if ((s % 8 == 7) || (s == slotsCount - 1)) { print line; line = "	" }
+		else line = line " "
+	}
+	print "};"
+}
@@ -40,12 +40,12 @@ template <int elt> class musicxml : public xmlelement
   */
   
 	static SMARTP<musicxml<elt> > new_musicxml (int inputLineNumber)  
-		{ musicxml<elt>* o = new musicxml<elt>(inputLineNumber); assert(o!=0); return o; }
+		{ musicxml<elt>* o = new musicxml<elt>(inputLineNumber); assert(o!=0); arena::created(o); return o; }
     static SMARTP<musicxml<elt> > new_musicxml ( const std::vector<Sxmlelement>& elts, int inputLineNumber)  
-		{ musicxml<elt>* o = new musicxml<elt>(elts, inputLineNumber); assert(o!=0); return o; }
+		{ musicxml<elt>* o = new musicxml<elt>(elts, inputLineNumber); assert(o!=0); arena::created(o); return o; }
 
     virtual void acceptIn (basevisitor& v) {
-		if (visitor<SMARTP<musicxml<elt> > >* p = dynamic_cast<visitor<SMARTP<musicxml<elt> > >*>(&v)) {
+		if (visitor<SMARTP<musicxml<elt> > >* p = v.getVisitor<visitor<SMARTP<musicxml<elt> > > >(elt)) {
 			SMARTP<musicxml<elt> > sptr = this;
 			p->visitStart (sptr);
 		}
@@ -53,7 +53,7 @@ template <int elt> class musicxml : public xmlelement
 	}
 
     virtual void acceptOut (basevisitor& v) {
-        if ( visitor<SMARTP<musicxml<elt> > >* p = dynamic_cast<visitor<SMARTP<musicxml<elt> > >*>(&v)) {
+        if ( visitor<SMARTP<musicxml<elt> > >* p = v.getVisitor<visitor<SMARTP<musicxml<elt> > > >(elt)) {
 			SMARTP<musicxml<elt> > sptr = this;
 			p->visitEnd (sptr);
         }
@@ -10,11 +10,16 @@
   research@grame.fr
 */
 
+#include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <iostream>
 
+#include "elements.h"
 #include "xml.h"
 #include "visitor.h"
 
@@ -23,21 +28,55 @@ using namespace std;
 namespace MusicXML2 
 {
 
+//______________________________________________________________________________
+// xmlnumber
+//______________________________________________________________________________
+void xmlnumber::set (const string& value)
+{
+	const char* ptr = value.c_str();
+	while (isspace((unsigned char)*ptr)) ptr++;
+	bool negative = (*ptr == '-');
+	const char* digits = ptr + (negative || (*ptr == '+'));
+	const char* end = digits;
+	while (isdigit((unsigned char)*end)) end++;
+
+	// fast path for the small integers, the most common numeric values
+	size_t n = end - digits;
+	if (n && (n <= 9) && (!*end || !strchr (".eExX", *end))) {
+		long value = 0;
+		for (const char* d = digits; d < end; d++)
+			value = value * 10 + (*d - '0');
+		fLong = negative ? -value : value;
+		fFloat = negative ? -float(value) : float(value);
+	}
+	// a number starts with a digit, a sign or a dot, strtod also accepts inf and nan
+	else if (isdigit((unsigned char)*ptr) || (*ptr && strchr ("+-.iInN", *ptr))) {
+		fLong = atol (ptr);
+		fFloat = (float)atof (ptr);
+	}
+	else {
+		fLong = 0;
+		fFloat = 0;
+	}
+}
+
 //______________________________________________________________________________
 // xmlattribute
 //______________________________________________________________________________
-Sxmlattribute xmlattribute::create() { xmlattribute * o = new xmlattribute; assert(o!=0); return o; }
+Sxmlattribute xmlattribute::create() { xmlattribute * o = new xmlattribute; assert(o!=0); arena::created(o); return o; }
 
 //______________________________________________________________________________
-void xmlattribute::setName (const string& name) 		{ fName = name; }
-void xmlattribute::setValue (const string& value) 		{ fValue = value; }
+void xmlattribute::setName (const string& name) 		{ data().name = nametable::intern(name); }
+void xmlattribute::setValue (const string& value) 		{ slot& d = data(); d.value = value; d.number.set(d.value); }
 
 //______________________________________________________________________________
 void xmlattribute::setValue (long value)
 {
 	stringstream s;
 	s << value;
-	s >> fValue;
+	slot& d = data();
+	s >> d.value;
+	d.number.set(d.value);
 }
 
 //______________________________________________________________________________
@@ -45,7 +84,9 @@ void xmlattribute::setValue (int value)
 {
 	stringstream s;
 	s << value;
-	s >> fValue;
+	slot& d = data();
+	s >> d.value;
+	d.number.set(d.value);
 }
 
 //______________________________________________________________________________
@@ -53,26 +94,29 @@ void xmlattribute::setValue (float value)
 {
 	stringstream s;
 	s << value;
-	s >> fValue;
+	slot& d = data();
+	s >> d.value;
+	d.number.set(d.value);
 }
 
-xmlattribute::operator int () const		{ return atoi(fValue.c_str()); }
-xmlattribute::operator long () const	{ return atol(fValue.c_str()); }
-xmlattribute::operator float () const	{ return (float)atof(fValue.c_str()); }
+xmlattribute::operator int () const		{ return int(data().number.getLong()); }
+xmlattribute::operator long () const	{ return data().number.getLong(); }
+xmlattribute::operator float () const	{ return data().number.getFloat(); }
 
 //______________________________________________________________________________
 // xmlelement
 //______________________________________________________________________________
-Sxmlelement xmlelement::create(int lineno)			{ xmlelement * o = new xmlelement(lineno); assert(o!=0); return o; }
+Sxmlelement xmlelement::create(int lineno)			{ xmlelement * o = new xmlelement(lineno); assert(o!=0); arena::created(o); return o; }
 void xmlelement::setValue (int value)				{ setValue((long)value); }
-void xmlelement::setValue (const string& value) 	{ fValue = value; }
-void xmlelement::setName (const string& name) 		{ fName = name; }
+void xmlelement::setValue (const string& value) 	{ fValue = value; fNumber.set(fValue); }
+void xmlelement::setName (const string& name) 		{ fName = nametable::intern(name); }
 //______________________________________________________________________________
 void xmlelement::setValue (long value)
 {
 	stringstream s;
 	s << value;
 	s >> fValue;
+	fNumber.set(fValue);
 }
 
 //______________________________________________________________________________
@@ -81,6 +125,7 @@ void xmlelement::setValue (unsigned long value)
 	stringstream s;
 	s << value;
 	s >> fValue;
+	fNumber.set(fValue);
 }
 
 //______________________________________________________________________________
@@ -89,18 +134,65 @@ void xmlelement::setValue (float value)
 	stringstream s;
 	s << value;
 	s >> fValue;
+	fNumber.set(fValue);
 }
 
 //______________________________________________________________________________
-long xmlelement::add (const Sxmlattribute& attr)
-{ 
-	fAttributes.push_back(attr);
+long xmlelement::add (nametable::name name, const string& value)
+{
+	fAttributes.push_back (xmlattribute::slot(name, value));
+	vector<Sxmlattribute>* views = fViews.load (std::memory_order_acquire);
+	if (views) {
+		Sxmlattribute view = xmlattribute::create();
+		view->fOwner = this;
+		view->fIndex = unsigned(fAttributes.size()-1);
+		views->push_back (view);
+	}
 	return long(fAttributes.size()-1);
 }
 
 //______________________________________________________________________________
+// an unbound attribute becomes a view on the new slot
+long xmlelement::add (const Sxmlattribute& attr)
+{
+	if (!attr) return -1;
+	if (attr->fOwner) return add (attr->getInternedName(), attr->getValue());
+
+	vector<Sxmlattribute>& views = const_cast<vector<Sxmlattribute>&>(attributes());
+	fAttributes.push_back (attr->fData);
+	attr->fOwner = this;
+	attr->fIndex = unsigned(fAttributes.size()-1);
+	attr->fData = xmlattribute::slot();
+	views.push_back (attr);
+	return long(attr->fIndex);
+}
+
+//______________________________________________________________________________
+// the views are created at once and published atomically: concurrent readers
+// may build them twice but always get the same vector
+const vector<Sxmlattribute>& xmlelement::attributes() const
+{
+	vector<Sxmlattribute>* views = fViews.load (std::memory_order_acquire);
+	if (views) return *views;
+
+	vector<Sxmlattribute>* created = new vector<Sxmlattribute>;
+	created->reserve (fAttributes.size());
+	for (unsigned i = 0; i < fAttributes.size(); i++) {
+		Sxmlattribute view = xmlattribute::create();
+		view->fOwner = const_cast<xmlelement*>(this);
+		view->fIndex = i;
+		created->push_back (view);
+	}
+	if (fViews.compare_exchange_strong (views, created, std::memory_order_acq_rel))
+		return *created;
+	delete created;
+	return *views;
+}
+
+//______________________________________________________________________________
+// the generic interface is cached at the kNoElement index
 void xmlelement::acceptIn(basevisitor& v) {
-	visitor<Sxmlelement>* p = dynamic_cast<visitor<Sxmlelement>*>(&v);
+	visitor<Sxmlelement>* p = v.getVisitor<visitor<Sxmlelement> >(0);
 	if (p) {
 		Sxmlelement xml = this;
 		p->visitStart (xml);
@@ -109,7 +201,7 @@ void xmlelement::acceptIn(basevisitor& v) {
 
 //______________________________________________________________________________
 void xmlelement::acceptOut(basevisitor& v) {
-	visitor<Sxmlelement>* p = dynamic_cast<visitor<Sxmlelement>*>(&v);
+	visitor<Sxmlelement>* p = v.getVisitor<visitor<Sxmlelement> >(0);
 	if (p) {
 		Sxmlelement xml = this;
 		p->visitEnd (xml);
@@ -117,77 +209,198 @@ void xmlelement::acceptOut(basevisitor& v) {
 }
 
 //______________________________________________________________________________
-const Sxmlattribute xmlelement::getAttribute(const string& attrname) const 
+// elements have a few attributes at most: comparing the names directly
+// is cheaper than interning the searched name
+const xmlattribute::slot* xmlelement::findAttribute (const string& attrname) const
 {
-	vector<Sxmlattribute>::const_iterator it;
-	for (it = attributes().begin(); it != attributes().end(); it++) {
-		if ((*it)->getName() == attrname)
-			return *it;
+	for (vector<xmlattribute::slot>::const_iterator it = fAttributes.begin(); it != fAttributes.end(); it++) {
+		if (*it->name == attrname)
+			return &(*it);
 	}
 	return 0;
 }
 
+//______________________________________________________________________________
+const Sxmlattribute xmlelement::getAttribute(const string& attrname) const 
+{
+	const xmlattribute::slot* attr = findAttribute (attrname);
+	return attr ? attributes()[attr - fAttributes.data()] : 0;
+}
+
 //______________________________________________________________________________
 const string xmlelement::getAttributeValue (const string& attrname) const
 {
-	Sxmlattribute attribute = getAttribute(attrname);
-	return attribute ? attribute->getValue() : "";
+	const xmlattribute::slot* attr = findAttribute (attrname);
+	return attr ? attr->value : "";
 }
 
 //______________________________________________________________________________
 long xmlelement::getAttributeLongValue (const string& attrname, long defaultvalue) const
 {
-	Sxmlattribute attribute = getAttribute(attrname);
-	return attribute ? atol(attribute->getValue().c_str()) : defaultvalue;
+	const xmlattribute::slot* attr = findAttribute (attrname);
+	return attr ? attr->number.getLong() : defaultvalue;
 }
 
 //______________________________________________________________________________
 int xmlelement::getAttributeIntValue (const string& attrname, int defaultvalue) const
 {
-	Sxmlattribute attribute = getAttribute(attrname);
-	return attribute ? atoi(attribute->getValue().c_str()) : defaultvalue;
+	const xmlattribute::slot* attr = findAttribute (attrname);
+	return attr ? int(attr->number.getLong()) : defaultvalue;
 }
 
 //______________________________________________________________________________
 float xmlelement::getAttributeFloatValue (const string& attrname, float defaultvalue) const
 {
-	Sxmlattribute attribute = getAttribute(attrname);
-	return attribute ? (float)atof(attribute->getValue().c_str()) : defaultvalue;
+	const xmlattribute::slot* attr = findAttribute (attrname);
+	return attr ? attr->number.getFloat() : defaultvalue;
 }
 
-xmlelement::operator int () const	{ return atoi(fValue.c_str()); }
-xmlelement::operator long () const	{ return atol(fValue.c_str()); }
-xmlelement::operator float () const { return (float)atof(fValue.c_str()); }
+xmlelement::operator int () const	{ return int(fNumber.getLong()); }
+xmlelement::operator long () const	{ return fNumber.getLong(); }
+xmlelement::operator float () const { return fNumber.getFloat(); }
 
 //______________________________________________________________________________
 bool xmlelement::operator ==(const xmlelement& elt) const
 {
 	if (getType() != elt.getType()) return false;
-	if (getName() != elt.getName()) return false;
+	if (getInternedName() != elt.getInternedName()) return false;
 	if (getValue()!= elt.getValue()) return false;
-	const vector<Sxmlattribute>& attr1 = attributes();
-	const vector<Sxmlattribute>& attr2 = elt.attributes();
+	const vector<xmlattribute::slot>& attr1 = attributeSlots();
+	const vector<xmlattribute::slot>& attr2 = elt.attributeSlots();
 	if (attr1.size() != attr2.size()) return false;
 
-	vector<Sxmlattribute>::const_iterator iter1 = attr1.begin();
-	vector<Sxmlattribute>::const_iterator iter2 = attr2.begin();
-	while (iter1 != attr1.end()) {
-		if (iter2 == attr2.end()) return false;
-		if ((*iter1)->getName() != (*iter2)->getName()) return false;
-		if ((*iter1)->getValue() != (*iter2)->getValue()) return false;
-		iter1++; iter2++;
+	for (size_t i = 0; i < attr1.size(); i++) {
+		if (attr1[i].name != attr2[i].name) return false;
+		if (attr1[i].value != attr2[i].value) return false;
 	}
 	return true;
 }
 
 //______________________________________________________________________________
+// the sub elements types index
+//______________________________________________________________________________
+struct xmlelement::typeindex
+{
+	typedef std::pair<int, int> occurrence;		// a type and the index of the first sub element containing it
+
+	unsigned long long		fTypes[(kEndElement + 63) / 64];	// a bitmap of the types present in the subtree
+	std::vector<occurrence>	fFirst;							// sorted by type
+
+	static bool indexed (int type)	{ return (type >= 0) && (type < kEndElement); }
+	bool has (int type) const		{ return (fTypes[type / 64] >> (type % 64)) & 1; }
+	int  first (int type) const		{ return std::lower_bound (fFirst.begin(), fFirst.end(), occurrence(type, 0))->second; }
+
+	void build (xmlelement* elt);
+	void add (int type, int sub) {
+		if (indexed(type) && !has(type)) {
+			fTypes[type / 64] |= 1ULL << (type % 64);
+			fFirst.push_back (occurrence(type, sub));
+		}
+	}
+};
+
+// the modifications drop the indexes only once an index has been built
+static std::atomic<bool>	gIndexed (false);
+static std::atomic<bool>	gIndexing (false);
+
+//______________________________________________________________________________
+void xmlelement::typeindex::build (xmlelement* elt)
+{
+	memset (fTypes, 0, sizeof(fTypes));
+	fFirst.clear();
+	const branchs& subs = elt->elements();
+	for (size_t i = 0; i < subs.size(); i++) {
+		add (subs[i]->getType(), int(i));
+		for (walker w (subs[i]); w != walker(); ++w)
+			add (w->getType(), int(i));
+	}
+	std::sort (fFirst.begin(), fFirst.end());
+}
+
+//______________________________________________________________________________
+void xmlelement::indexing (bool state)	{ gIndexing.store (state, std::memory_order_relaxed); }
+
+//______________________________________________________________________________
+// the views that outlive the element get their own copy of the attribute
+xmlelement::~xmlelement()
+{
+	delete fIndex.load (std::memory_order_relaxed);
+	vector<Sxmlattribute>* views = fViews.load (std::memory_order_relaxed);
+	if (views) {
+		for (vector<Sxmlattribute>::iterator i = views->begin(); i != views->end(); i++) {
+			if ((*i)->fOwner == this) {
+				(*i)->fData = fAttributes[(*i)->fIndex];
+				(*i)->fOwner = 0;
+			}
+		}
+		delete views;
+	}
+}
+
+// the index of the element and the indexes of its ancestors describe the modified subtree
+void xmlelement::modified ()
+{
+	if (!gIndexed.load (std::memory_order_relaxed)) return;
+	for (xmlelement* elt = this; elt; elt = elt->parent())
+		delete elt->fIndex.exchange (0, std::memory_order_acq_rel);
+}
+
+// the index is published atomically: concurrent calls on a shared tree may build
+// it several times, but they all get the same index
+const xmlelement::typeindex* xmlelement::index ()
+{
+	if (!gIndexing.load (std::memory_order_relaxed)) return 0;
+	typeindex* index = fIndex.load (std::memory_order_acquire);
+	if (index) return index;
+
+	gIndexed.store (true, std::memory_order_relaxed);
+	index = new typeindex;
+	index->build (this);
+	typeindex* current = 0;
+	if (fIndex.compare_exchange_strong (current, index, std::memory_order_acq_rel))
+		return index;
+	delete index;
+	return current;
+}
+
+//______________________________________________________________________________
+// looks for the first element of a given type in a subtree, without reference count change
+static xmlelement* lookup (xmlelement* elt, int type)
+{
+	for (xmlelement::walker w (elt); w != xmlelement::walker(); ++w)
+		if (w->getType() == type) return *w;
+	return 0;
+}
+
 ctree<xmlelement>::iterator xmlelement::find(int type)
 { 
-	return find(type, begin());
+	xmlelement* elt;
+	const typeindex* index = typeindex::indexed(type) ? this->index() : 0;
+	if (index) {
+		if (!index->has(type)) return end();
+		// skip the sub elements that don't contain the type
+		literator sub = lbegin() + index->first(type);
+		if ((*sub)->getType() == type) {
+			Sxmlelement self (this);
+			return iterator(self, sub);
+		}
+		elt = lookup (*sub, type);
+	}
+	else elt = lookup (this, type);
+	if (!elt) return end();
+
+	iterator iter = locate (elt);
+	// the parent links are missing when the tree is modified using elements()
+	return (iter != end()) ? iter : find(type, begin());
 }
 
 ctree<xmlelement>::iterator xmlelement::find(int type, ctree<xmlelement>::iterator iter)
 {
+	// the index can only be used when iter browses the current element
+	if (typeindex::indexed(type) && (iter.getRoot() == this)) {
+		const typeindex* index = this->index();
+		if (index && !index->has(type)) return end();
+	}
 	while (iter != end()) {
 		if ((*iter)->getType() == type) break;
 		iter++;
@@ -195,6 +408,49 @@ ctree<xmlelement>::iterator xmlelement::find(int type, ctree<xmlelement>::iterat
 	return iter;
 }
 
+//______________________________________________________________________________
+// browsing in document order
+//______________________________________________________________________________
+static bool orderedBefore (const Sxmlelement& elt, long order)	{ return elt->getOrder() < order; }
+
+ctree<xmlelement>::literator xmlelement::lfind (const xmlelement* elt)
+{
+	// the sub elements created by the parser are sorted by document order
+	long order = elt->getOrder();
+	if (order) {
+		literator i = std::lower_bound (lbegin(), lend(), order, orderedBefore);
+		if ((i != lend()) && (*i == elt)) return i;
+	}
+	return ctree<xmlelement>::lfind (elt);
+}
+
+Sxmlelement xmlelement::next ()
+{
+	if (size()) return elements().front();
+	Sxmlelement elt = this;
+	Sxmlelement parent = elt->parent();
+	while (parent) {
+		literator i = parent->lfind (elt);
+		if (i == parent->lend()) break;		// inconsistent parent link
+		if (++i != parent->lend()) return *i;
+		elt = parent;
+		parent = elt->parent();
+	}
+	return 0;
+}
+
+Sxmlelement xmlelement::prev ()
+{
+	Sxmlelement parent = this->parent();
+	if (!parent) return 0;
+	literator i = parent->lfind (this);
+	if (i == parent->lend()) return 0;		// inconsistent parent link
+	if (i == parent->lbegin()) return parent;
+	Sxmlelement elt = *(--i);
+	while (elt->size()) elt = elt->elements().back();
+	return elt;
+}
+
 //______________________________________________________________________________
 const std::string xmlelement::getValue (int subElementType)
 {
@@ -13,6 +13,7 @@
 #ifndef __xml__
 #define __xml__
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -21,7 +22,9 @@
 #endif
 
 #include "exports.h"
+#include "arena.h"
 #include "ctree.h"
+#include "nametable.h"
 #include "smartpointer.h"
 
 namespace MusicXML2
@@ -38,32 +41,81 @@ class xmlattribute;
 typedef SMARTP<xmlattribute> 	Sxmlattribute;
 typedef SMARTP<xmlelement> 		Sxmlelement;
 
+/*!
+\brief the numeric conversions of a value.
+
+	The conversions are computed once, when the value is set, and give the same
+	results as atol and atof. Values that can't start a number are converted to 0
+	without parsing.
+*/
+//______________________________________________________________________________
+class EXP xmlnumber {
+	long	fLong;
+	float	fFloat;
+	public:
+				 xmlnumber() : fLong(0), fFloat(0) {}
+
+		void	set (const std::string& value);
+		long	getLong () const	{ return fLong; }
+		float	getFloat () const	{ return fFloat; }
+};
+
 /*!
 \brief A generic xml attribute representation.
 
 	An attribute is represented by its name and its value.
+	The name is interned in the global nametable.
+
+	The attributes of an element are stored inline by the element (see xmlattribute::slot):
+	an attribute added to an element, or obtained from an element, is a view on the element
+	storage and modifying it modifies the element. A view outlives its element: it gets
+	its own copy of the attribute when the element is deleted.
 */
 //______________________________________________________________________________
 class EXP xmlattribute : public smartable {
-	//! the attribute name
-	std::string	fName;
-	//! the attribute value
-	std::string 	fValue;
+	public:
+		//! the attribute storage
+		struct slot {
+			nametable::name	name;
+			std::string		value;
+			xmlnumber		number;		// the value numeric conversions
+			slot() : name(nametable::empty()) {}
+			slot(nametable::name n, const std::string& v) : name(n), value(v) { number.set(value); }
+		};
+
+	private:
+		friend class xmlelement;
+		//! the attribute storage when not bound to an element
+		slot			fData;
+		//! the element that stores the attribute, if any
+		xmlelement*		fOwner;
+		//! the attribute index in the owner storage
+		unsigned		fIndex;
+
+		inline slot&		data ();
+		inline const slot&	data () const;
+
     protected:
-		xmlattribute() {}
+		xmlattribute() : fOwner(0), fIndex(0) {}
 		virtual ~xmlattribute() {}
     public:
 		static SMARTP<xmlattribute> create();
 
+		static void* operator new (size_t size)		{ return arena::newObject (size); }
+		static void  operator delete (void* ptr)	{ arena::deleteObject (ptr); }
+
 		void setName (const std::string& name);
+		void setName (nametable::name name)		{ data().name = name; }
 		void setValue (const std::string& value);
 		void setValue (long value);
 		void setValue (int value);
 		void setValue (float value);
 
-		const std::string& getName () const		{ return fName; }
+		const std::string& getName () const		{ return *data().name; }
+		//! returns the interned attribute name
+		nametable::name	getInternedName () const	{ return data().name; }
 		//! returns the attribute value as a string
-		const std::string& getValue () const	{ return fValue; }
+		const std::string& getValue () const	{ return data().value; }
 		//! returns the attribute value as a int
 		operator int () const;
 		//! returns the attribute value as a long
@@ -79,47 +131,86 @@ class EXP xmlattribute : public smartable {
 	An element is represented by its name, its value,
 	the lists of its attributes and its enclosed elements.
 	Attributes and elements must be added in the required
-	order.
+	order. The name is interned in the global nametable.
+
+	The attributes are stored inline: the getAttributeXxx methods read the storage
+	directly. The Sxmlattribute views returned by attributes() and getAttribute()
+	are only created when first requested.
+
+	When the indexing is enabled (see indexing()), find() relies on an index of
+	the sub elements types, built on the first call and dropped by any modification
+	of the element or of its subtree (see ctree::modified). The index is published
+	atomically: concurrent calls to find() on a shared tree are safe, as long as
+	the tree is not modified. Modifications of a shared sub element (see ctree::share)
+	don't reach the other trees: modified() must then be called on these trees.
 */
 //______________________________________________________________________________
 class EXP xmlelement : public ctree<xmlelement>, public visitable
 {
 	private:
+		friend class xmlattribute;
 		//! the element name
-		std::string fName;
+		nametable::name fName;
 		//! the element value
 		std::string fValue;
-		//! list of the element attributes
-		std::vector<Sxmlattribute> fAttributes;
+		//! the element value numeric conversions
+		xmlnumber fNumber;
+		//! the element attributes, stored inline
+		// a vector rather than a small inline buffer: most elements have no attribute
+		// and an inline slot would make all of them larger
+		std::vector<xmlattribute::slot> fAttributes;
+		//! the attributes views, created on demand by attributes()
+		mutable std::atomic<std::vector<Sxmlattribute>*> fViews;
+		//! the sub elements types index, built on demand by find()
+		struct typeindex;
+		std::atomic<typeindex*> fIndex;
+
+		const typeindex* index ();
 
 	protected:
 		// the element type
 		int fType;
 		// the input line number for messages to the user
 		int fInputLineNumber;
+		// the element position in document order, set by the parser
+		long fOrder;
 
-				 xmlelement (int inputLineNumber) : fType(0), fInputLineNumber(inputLineNumber) {}
-		virtual ~xmlelement() {}
+				 xmlelement (int inputLineNumber) : fName(nametable::empty()), fViews(0), fIndex(0), fType(0), fInputLineNumber(inputLineNumber), fOrder(0) {}
+		virtual ~xmlelement();
 
 	public:
 		typedef ctree<xmlelement>::iterator     iterator;
 
 		static SMARTP<xmlelement> create (int inputLineNumber);
 
+		//! enables or disables the sub elements types index used by find() (disabled by default)
+		static void indexing (bool state);
+
+		//! elements are allocated from the current arena if any (see arena::scope)
+		static void* operator new (size_t size)		{ return arena::newObject (size); }
+		static void  operator delete (void* ptr)	{ arena::deleteObject (ptr); }
+
 		virtual void acceptIn  (basevisitor& visitor);
 		virtual void acceptOut (basevisitor& visitor);
 
 		int getInputLineNumber () { return fInputLineNumber; }
 
+		//! the element position in document order (0 when not set)
+		long getOrder () const		{ return fOrder; }
+		void setOrder (long order)	{ fOrder = order; }
+
 		void setValue (unsigned long value);
 		void setValue (long value);
 		void setValue (int value);
 		void setValue (float value);
 		void setValue (const std::string& value);
 		void setName  (const std::string& name);
+		void setName  (nametable::name name)	{ fName = name; }
 
 		int                 getType () const    { return fType; }
-		const std::string&  getName () const    { return fName; }
+		const std::string&  getName () const    { return *fName; }
+		//! returns the interned element name
+		nametable::name     getInternedName () const	{ return fName; }
 
 		//! returns the element value as a string
 		const std::string& getValue () const    { return fValue; }
@@ -134,17 +225,39 @@ class EXP xmlelement : public ctree<xmlelement>, public visitable
 		bool operator ==(const xmlelement& elt) const;
 		bool operator !=(const xmlelement& elt) const { return !(*this == elt); }
 
-		//! adds an attribute to the element
+		/*! \brief adds an attribute to the element
+			The attribute becomes a view on the element storage, unless it is already
+			bound to another element: its name and value are then copied.
+		*/
 		long add (const Sxmlattribute& attr);
+		//! adds an attribute to the element
+		long add (nametable::name name, const std::string& value);
 
 		// getting information about attributes
-		const std::vector<Sxmlattribute>& attributes() const { return fAttributes; }
+		//! the attributes storage, in document order
+		const std::vector<xmlattribute::slot>& attributeSlots() const { return fAttributes; }
+		//! looks for an attribute by name, returns 0 when not found
+		const xmlattribute::slot* findAttribute (const std::string& attrname) const;
+		//! the attributes views, created on the first call
+		const std::vector<Sxmlattribute>& attributes() const;
 		const Sxmlattribute getAttribute      (const std::string& attrname) const;
 		const std::string   getAttributeValue   (const std::string& attrname) const;
 		long                getAttributeLongValue (const std::string& attrname, long defaultvalue) const;
 		int                 getAttributeIntValue  (const std::string& attrname, int defaultvalue) const;
 		float               getAttributeFloatValue  (const std::string& attrname, float defaultvalue) const;
 
+		//! drops the sub elements types indexes of the element and of its ancestors
+		virtual void modified ();
+
+		//! looks for a direct sub element, using the document order when available
+		virtual literator lfind (const xmlelement* elt);
+
+		// browsing the tree in document order using the parent links
+		//! the next element in document order: the first sub element, the next sibling or the next sibling of an ancestor
+		Sxmlelement next ();
+		//! the previous element in document order: the last descendant of the previous sibling or the parent
+		Sxmlelement prev ();
+
 		// finding sub elements by type
 		ctree<xmlelement>::iterator     find(int type);
 		ctree<xmlelement>::iterator     find(int type, ctree<xmlelement>::iterator start);
@@ -160,6 +273,10 @@ class EXP xmlelement : public ctree<xmlelement>, public visitable
 		bool empty () const	{ return fValue.empty() && elements().empty(); }
 };
 
+//______________________________________________________________________________
+inline xmlattribute::slot& xmlattribute::data ()				{ return fOwner ? fOwner->fAttributes[fIndex] : fData; }
+inline const xmlattribute::slot& xmlattribute::data () const	{ return fOwner ? fOwner->fAttributes[fIndex] : fData; }
+
 /*! @} */
 
 }
@@ -114,6 +114,13 @@ bool xmlorder::operator() (Sxmlelement a, Sxmlelement b)
 	return aIndex < bIndex;
 }
 
+// sorts the sub elements of an element: the element is notified of the modification
+static void sortElements (const Sxmlelement& elt, map<int,int>& order)
+{
+	std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(order, elt));
+	elt->modified();
+}
+
 //______________________________________________________________________________
 sortvisitor::sortvisitor () 
 {
@@ -417,160 +424,160 @@ sortvisitor::sortvisitor ()
 
 //______________________________________________________________________________
 void sortvisitor::visitStart( S_accord& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gAccordOrder, elt)); }
+	{ sortElements (elt, gAccordOrder); }
 
 void sortvisitor::visitStart( S_accordion_registration& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gAccordionRegistrationOrder, elt)); }
+	{ sortElements (elt, gAccordionRegistrationOrder); }
 
 void sortvisitor::visitStart( S_appearance& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gAppearanceOrder, elt)); }
+	{ sortElements (elt, gAppearanceOrder); }
 
 void sortvisitor::visitStart( S_attributes& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gAttributesOrder, elt)); }
+	{ sortElements (elt, gAttributesOrder); }
 
 void sortvisitor::visitStart( S_backup& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gBackupOrder, elt)); }
+	{ sortElements (elt, gBackupOrder); }
 
 void sortvisitor::visitStart( S_barline& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gBarlineOrder, elt)); }
+	{ sortElements (elt, gBarlineOrder); }
 
 void sortvisitor::visitStart( S_bass& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gBassOrder, elt)); }
+	{ sortElements (elt, gBassOrder); }
 
 void sortvisitor::visitStart( S_beat_repeat& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gBeatRepeatOrder, elt)); }
+	{ sortElements (elt, gBeatRepeatOrder); }
 
 void sortvisitor::visitStart( S_bend& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gBendOrder, elt)); }
+	{ sortElements (elt, gBendOrder); }
 
 void sortvisitor::visitStart( S_clef& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gClefOrder, elt)); }
+	{ sortElements (elt, gClefOrder); }
 
 void sortvisitor::visitStart( S_defaults& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gDefaultsOrder, elt)); }
+	{ sortElements (elt, gDefaultsOrder); }
 
 void sortvisitor::visitStart( S_degree& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gDegreeOrder, elt)); }
+	{ sortElements (elt, gDegreeOrder); }
 
 void sortvisitor::visitStart( S_direction& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gDirectionOrder, elt)); }
+	{ sortElements (elt, gDirectionOrder); }
 
 void sortvisitor::visitStart( S_figure& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gFigureOrder, elt)); }
+	{ sortElements (elt, gFigureOrder); }
 
 void sortvisitor::visitStart( S_figured_bass& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gFiguredBassOrder, elt)); }
+	{ sortElements (elt, gFiguredBassOrder); }
 
 void sortvisitor::visitStart( S_forward& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gForwardOrder, elt)); }
+	{ sortElements (elt, gForwardOrder); }
 
 void sortvisitor::visitStart( S_frame_note& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gFrameNoteOrder, elt)); }
+	{ sortElements (elt, gFrameNoteOrder); }
 
 void sortvisitor::visitStart( S_frame& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gFrameOrder, elt)); }
+	{ sortElements (elt, gFrameOrder); }
 
 void sortvisitor::visitStart( S_harmonic& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gHarmonicOrder, elt)); }
+	{ sortElements (elt, gHarmonicOrder); }
 
 void sortvisitor::visitStart( S_harmony& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gHarmonyOrder, elt)); }
+	{ sortElements (elt, gHarmonyOrder); }
 
 void sortvisitor::visitStart( S_identification& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gIdentificationOrder, elt)); }
+	{ sortElements (elt, gIdentificationOrder); }
 
 void sortvisitor::visitStart( S_measure_style& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gMeasureStyleOrder, elt)); }
+	{ sortElements (elt, gMeasureStyleOrder); }
 
 void sortvisitor::visitStart( S_metronome_note& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gMetronomeNoteOrder, elt)); }
+	{ sortElements (elt, gMetronomeNoteOrder); }
 
 void sortvisitor::visitStart( S_metronome_tuplet& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gMetronomeTupletOrder, elt)); }
+	{ sortElements (elt, gMetronomeTupletOrder); }
 
 void sortvisitor::visitStart( S_midi_instrument& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gMidiInstrumentOrder, elt)); }
+	{ sortElements (elt, gMidiInstrumentOrder); }
 
 void sortvisitor::visitStart( S_notations& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gNotationsOrder, elt)); }
+	{ sortElements (elt, gNotationsOrder); }
 
 void sortvisitor::visitStart( S_note& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gNoteOrder, elt)); }
+	{ sortElements (elt, gNoteOrder); }
 
 void sortvisitor::visitStart( S_page_layout& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gPageLayoutOrder, elt)); }
+	{ sortElements (elt, gPageLayoutOrder); }
 
 void sortvisitor::visitStart( S_page_margins& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gPageMarginsOrder, elt)); }
+	{ sortElements (elt, gPageMarginsOrder); }
 
 void sortvisitor::visitStart( S_part_group& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gPartGroupOrder, elt)); }
+	{ sortElements (elt, gPartGroupOrder); }
 
 void sortvisitor::visitStart( S_pedal_tuning& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gPedalTuningOrder, elt)); }
+	{ sortElements (elt, gPedalTuningOrder); }
 
 void sortvisitor::visitStart( S_pitch& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gPitchOrder, elt)); }
+	{ sortElements (elt, gPitchOrder); }
 
 void sortvisitor::visitStart( S_print& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gPrintOrder, elt)); }
+	{ sortElements (elt, gPrintOrder); }
 
 void sortvisitor::visitStart( S_rest& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gRestOrder, elt)); }
+	{ sortElements (elt, gRestOrder); }
 
 void sortvisitor::visitStart( S_root& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gRootOrder, elt)); }
+	{ sortElements (elt, gRootOrder); }
 
 void sortvisitor::visitStart( S_scaling& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gScalingOrder, elt)); }
+	{ sortElements (elt, gScalingOrder); }
 
 void sortvisitor::visitStart( S_score_instrument& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gScoreInstrumentOrder, elt)); }
+	{ sortElements (elt, gScoreInstrumentOrder); }
 
 void sortvisitor::visitStart( S_score_part& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gScorePartOrder, elt)); }
+	{ sortElements (elt, gScorePartOrder); }
 
 void sortvisitor::visitStart( S_score_partwise& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gScorePartwiseOrder, elt)); }
+	{ sortElements (elt, gScorePartwiseOrder); }
 
 void sortvisitor::visitStart( S_slash& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gSlashOrder, elt)); }
+	{ sortElements (elt, gSlashOrder); }
 
 void sortvisitor::visitStart( S_sound& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gSoundOrder, elt)); }
+	{ sortElements (elt, gSoundOrder); }
 
 void sortvisitor::visitStart( S_staff_details& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gStaffDetailsOrder, elt)); }
+	{ sortElements (elt, gStaffDetailsOrder); }
 
 void sortvisitor::visitStart( S_staff_tuning& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gStaffTuningOrder, elt)); }
+	{ sortElements (elt, gStaffTuningOrder); }
 
 void sortvisitor::visitStart( S_system_layout& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gSystemLayoutOrder, elt)); }
+	{ sortElements (elt, gSystemLayoutOrder); }
 
 void sortvisitor::visitStart( S_system_margins& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gSystemMarginsOrder, elt)); }
+	{ sortElements (elt, gSystemMarginsOrder); }
 
 void sortvisitor::visitStart( S_time_modification& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gTimeModificationOrder, elt)); }
+	{ sortElements (elt, gTimeModificationOrder); }
 
 void sortvisitor::visitStart( S_transpose& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gTransposeOrder, elt)); }
+	{ sortElements (elt, gTransposeOrder); }
 
 void sortvisitor::visitStart( S_tuplet_actual& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gTupletActualOrder, elt)); }
+	{ sortElements (elt, gTupletActualOrder); }
 
 void sortvisitor::visitStart( S_tuplet_normal& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gTupletNormalOrder, elt)); }
+	{ sortElements (elt, gTupletNormalOrder); }
 
 void sortvisitor::visitStart( S_tuplet& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gTupletOrder, elt)); }
+	{ sortElements (elt, gTupletOrder); }
 
 void sortvisitor::visitStart( S_unpitched& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gUnpitchedOrder, elt)); }
+	{ sortElements (elt, gUnpitchedOrder); }
 
 void sortvisitor::visitStart( S_work& elt )
-	{ std::sort (elt->elements().begin(), elt->elements().end(), xmlorder(gWorkOrder, elt)); }
+	{ sortElements (elt, gWorkOrder); }
 
 
 
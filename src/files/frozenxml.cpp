@@ -0,0 +1,155 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <algorithm>
+#include "frozenxml.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// frozenxml
+//______________________________________________________________________________
+Sfrozenxml frozenxml::create (const Sxmlelement& root)	{ frozenxml* o = new frozenxml(root); assert(o!=0); return o; }
+
+frozenxml::frozenxml (const Sxmlelement& root) : fRoot(root)
+{
+	if (root) {
+		add (root, -1);
+		vector<int> path (1, 0);		// the last element index at each depth
+		for (xmlelement::walker w (root); w != xmlelement::walker(); ++w) {
+			int depth = w.depth();
+			int i = add (*w, path[depth-1]);
+			if (int(path.size()) > depth) {
+				fNextSiblings[path[depth]] = i;
+				path.resize (depth);
+			}
+			else fFirstChilds[path[depth-1]] = i;
+			path.push_back (i);
+		}
+	}
+	fValues.push_back (unsigned(fPool.size()));
+	fAttributes.push_back (int(fAttributeNames.size()));
+}
+
+//______________________________________________________________________________
+unsigned frozenxml::store (const string& value)
+{
+	unsigned offset = unsigned(fPool.size());
+	fPool.append (value);
+	fPool.push_back (0);
+	return offset;
+}
+
+int frozenxml::add (xmlelement* elt, int parent)
+{
+	fTypes.push_back (elt->getType());
+	fNames.push_back (elt->getInternedName());
+	fParents.push_back (parent);
+	fFirstChilds.push_back (-1);
+	fNextSiblings.push_back (-1);
+	fValues.push_back (store (elt->getValue()));
+	fAttributes.push_back (int(fAttributeNames.size()));
+	const vector<xmlattribute::slot>& attributes = elt->attributeSlots();
+	for (vector<xmlattribute::slot>::const_iterator i = attributes.begin(); i != attributes.end(); i++) {
+		fAttributeNames.push_back (i->name);
+		fAttributeValues.push_back (store (i->value));
+	}
+	fElements.push_back (elt);
+	return size() - 1;
+}
+
+//______________________________________________________________________________
+size_t frozenxml::getValueSize (int i) const
+{
+	// the pool stores each element value followed by its attributes values
+	unsigned end = (attributesBegin(i) < attributesEnd(i)) ? fAttributeValues[attributesBegin(i)] : fValues[i+1];
+	return end - fValues[i] - 1;
+}
+
+//______________________________________________________________________________
+int frozenxml::getSubtreeEnd (int i) const
+{
+	while ((i >= 0) && (fNextSiblings[i] < 0))
+		i = fParents[i];
+	return (i < 0) ? size() : fNextSiblings[i];
+}
+
+//______________________________________________________________________________
+int frozenxml::findAttribute (int i, const string& name) const
+{
+	nametable::name interned = nametable::find (name);
+	if (interned) {
+		for (int a = attributesBegin(i); a < attributesEnd(i); a++)
+			if (fAttributeNames[a] == interned) return a;
+	}
+	return -1;
+}
+
+//______________________________________________________________________________
+int frozenxml::find (int type, int from) const
+{
+	for (int i = from; i < size(); i++)
+		if (fTypes[i] == type) return i;
+	return -1;
+}
+
+//______________________________________________________________________________
+static bool orderedBefore (const xmlelement* elt, long order)	{ return elt->getOrder() < order; }
+
+int frozenxml::index (const xmlelement* elt) const
+{
+	// the elements created by the parser are sorted by document order
+	if (elt->getOrder()) {
+		vector<xmlelement*>::const_iterator i = lower_bound (fElements.begin(), fElements.end(), elt->getOrder(), orderedBefore);
+		if ((i != fElements.end()) && (*i == elt)) return int(i - fElements.begin());
+	}
+	vector<xmlelement*>::const_iterator i = std::find (fElements.begin(), fElements.end(), elt);
+	return (i != fElements.end()) ? int(i - fElements.begin()) : -1;
+}
+
+//______________________________________________________________________________
+// frozen_tree_browser
+//______________________________________________________________________________
+void frozen_tree_browser::browse (xmlelement& t)
+{
+	int i = fDocument->index (&t);
+	if (i >= 0) browse (i);
+}
+
+void frozen_tree_browser::browse (int root)
+{
+	const frozenxml* doc = fDocument;
+	int i = root;
+	while (true) {
+		doc->element(i)->acceptIn (*fVisitor);
+		if (doc->getFirstChild(i) >= 0) {
+			i = doc->getFirstChild(i);
+			continue;
+		}
+		// leaves the element and its ancestors up to the next sibling
+		while (true) {
+			doc->element(i)->acceptOut (*fVisitor);
+			if (i == root) return;
+			int next = doc->getNextSibling(i);
+			if (next >= 0) {
+				i = next;
+				break;
+			}
+			i = doc->getParent(i);
+		}
+	}
+}
+
+}
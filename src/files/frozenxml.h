@@ -0,0 +1,135 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __frozenxml__
+#define __frozenxml__
+
+#include <string>
+#include <vector>
+
+#include "exports.h"
+#include "browser.h"
+#include "nametable.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+/*!
+\addtogroup MusicXML
+@{
+*/
+
+//______________________________________________________________________________
+/*!
+\brief a read only, flattened representation of an elements tree.
+
+	The elements are numbered in document order, the root element is at index 0.
+	The structure is stored as arrays indexed by element number (types, names, parent,
+	first child and next sibling indices), the values and the attributes values are
+	stored in a single strings pool. A missing element index is represented by -1.
+
+	The frozen document keeps the tree alive: the elements remain available to the
+	visitors (see frozen_tree_browser) but the tree structure must not be modified.
+*/
+class EXP frozenxml : public smartable
+{
+	public:
+		//! creates the frozen representation of the tree \c root
+		static SMARTP<frozenxml> create (const Sxmlelement& root);
+
+		//! the number of elements
+		int					size () const					{ return int(fTypes.size()); }
+
+		int					getType (int i) const			{ return fTypes[i]; }
+		const std::string&	getName (int i) const			{ return *fNames[i]; }
+		nametable::name		getInternedName (int i) const	{ return fNames[i]; }
+		//! the element value, a null terminated string
+		const char*			getValue (int i) const			{ return fPool.data() + fValues[i]; }
+		size_t				getValueSize (int i) const;
+
+		int					getParent (int i) const			{ return fParents[i]; }
+		int					getFirstChild (int i) const		{ return fFirstChilds[i]; }
+		int					getNextSibling (int i) const	{ return fNextSiblings[i]; }
+		//! the index following the subtree of the element \c i
+		int					getSubtreeEnd (int i) const;
+
+		//! the attributes of the element \c i are numbered from attributesBegin(i) to attributesEnd(i) (excluded)
+		int					attributesBegin (int i) const	{ return fAttributes[i]; }
+		int					attributesEnd (int i) const		{ return fAttributes[i+1]; }
+		const std::string&	getAttributeName (int a) const	{ return *fAttributeNames[a]; }
+		const char*			getAttributeValue (int a) const	{ return fPool.data() + fAttributeValues[a]; }
+		//! looks for an attribute of the element \c i by name, returns -1 when not found
+		int					findAttribute (int i, const std::string& name) const;
+
+		//! looks for the first element of type \c type starting at index \c from, returns -1 when not found
+		int					find (int type, int from = 0) const;
+
+		//! the element at index \c i
+		xmlelement*			element (int i) const			{ return fElements[i]; }
+		//! gives the index of an element, -1 when it is not part of the frozen tree
+		int					index (const xmlelement* elt) const;
+
+	protected:
+				 frozenxml (const Sxmlelement& root);
+		virtual ~frozenxml() {}
+
+	private:
+		Sxmlelement						fRoot;				// keeps the elements alive
+		std::vector<int>				fTypes;
+		std::vector<nametable::name>	fNames;
+		std::vector<int>				fParents;
+		std::vector<int>				fFirstChilds;
+		std::vector<int>				fNextSiblings;
+		std::vector<unsigned>			fValues;			// the values offsets in fPool, size()+1 entries
+		std::vector<int>				fAttributes;		// the first attribute of each element, size()+1 entries
+		std::vector<nametable::name>	fAttributeNames;
+		std::vector<unsigned>			fAttributeValues;	// the attributes values offsets in fPool
+		std::string						fPool;				// the null terminated values
+		std::vector<xmlelement*>		fElements;
+
+		unsigned	store (const std::string& value);
+		int			add (xmlelement* elt, int parent);
+};
+typedef SMARTP<frozenxml> Sfrozenxml;
+
+//______________________________________________________________________________
+/*!
+\brief browses a frozen document in document order.
+
+	The visitors are called with the frozen document elements, exactly as with
+	an xml_tree_browser, but the browsing itself only reads the frozen arrays.
+*/
+class EXP frozen_tree_browser : public browser<xmlelement>
+{
+	protected:
+		basevisitor*	fVisitor;
+		Sfrozenxml		fDocument;
+
+	public:
+				 frozen_tree_browser(basevisitor* v, const Sfrozenxml& doc) : fVisitor(v), fDocument(doc) {}
+		virtual ~frozen_tree_browser() {}
+
+		virtual void set (basevisitor* v)	{  fVisitor = v; }
+		//! browses the subtree of \c t, which must be part of the frozen document
+		virtual void browse (xmlelement& t);
+		//! browses the subtree of the element at index \c i
+		virtual void browse (int i);
+		//! browses the whole document
+		virtual void browse ()				{ if (fDocument->size()) browse (0); }
+};
+
+/*! @} */
+
+}
+
+#endif
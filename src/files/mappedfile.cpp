@@ -0,0 +1,208 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "mappedfile.h"
+
+using namespace std;
+
+extern "C" {
+bool readmemory (char * buffer, size_t size, reader * r);
+}
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+mappedfile::mappedfile (const char* file)
+	: fData(0), fSize(0), fMap(0), fMapSize(0), fBuffer(0)
+{
+	if (map (file) || load (file)) decode();
+}
+
+//______________________________________________________________________________
+mappedfile::mappedfile (char* buffer, size_t size)
+	: fData(buffer), fSize(size), fMap(0), fMapSize(0), fBuffer(buffer)
+{
+	if (buffer && (size >= 2)) decode();
+	else release();
+}
+
+//______________________________________________________________________________
+// handles the byte order marks
+void mappedfile::decode ()
+{
+	const unsigned char* ptr = (const unsigned char*)fData;
+	size_t size = fSize - 2;
+	if ((size >= 2) && (ptr[0] == 0xff) && (ptr[1] == 0xfe))
+		transcode (ptr + 2, size - 2, false);
+	else if ((size >= 2) && (ptr[0] == 0xfe) && (ptr[1] == 0xff))
+		transcode (ptr + 2, size - 2, true);
+	else if ((size >= 3) && (ptr[0] == 0xef) && (ptr[1] == 0xbb) && (ptr[2] == 0xbf)) {
+		fData += 3;		// skip the UTF-8 byte order mark
+		fSize -= 3;
+	}
+}
+
+//______________________________________________________________________________
+mappedfile::~mappedfile ()	{ release(); }
+
+//______________________________________________________________________________
+void mappedfile::release ()
+{
+#ifndef WIN32
+	if (fMap) munmap (fMap, fMapSize);
+#endif
+	free (fBuffer);
+	fMap = 0;
+	fMapSize = 0;
+	fBuffer = 0;
+	fData = 0;
+	fSize = 0;
+}
+
+//______________________________________________________________________________
+// maps the file (copy on write: the scanner temporarily writes into its input)
+// the mapping is only used when the last page has room for the 2 terminating null
+// chars, the bytes following the end of file in the last page are zero filled.
+bool mappedfile::map (const char* file)
+{
+#ifndef WIN32
+	int fd = open (file, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if ((fstat (fd, &st) < 0) || (st.st_size <= 0)) {
+		close (fd);
+		return false;
+	}
+	size_t size = size_t(st.st_size);
+	size_t page = size_t(sysconf (_SC_PAGESIZE));
+	size_t tail = size % page;
+	if (!tail || ((page - tail) < 2)) {
+		close (fd);
+		return false;
+	}
+	void* ptr = mmap (0, size + 2, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (ptr == MAP_FAILED) return false;
+#ifdef MADV_SEQUENTIAL
+	madvise (ptr, size + 2, MADV_SEQUENTIAL);
+#endif
+	fMap = ptr;
+	fMapSize = size + 2;
+	fData = (char*)ptr;
+	fSize = size + 2;
+	return true;
+#else
+	return false;
+#endif
+}
+
+//______________________________________________________________________________
+// reads the whole file in a single block
+bool mappedfile::load (const char* file)
+{
+	FILE* fd = fopen (file, "rb");
+	if (!fd) return false;
+	bool ok = false;
+	if (fseek (fd, 0, SEEK_END) == 0) {
+		long size = ftell (fd);
+		if ((size > 0) && (fseek (fd, 0, SEEK_SET) == 0)) {
+			fBuffer = (char*)malloc (size_t(size) + 2);
+			if (fBuffer && (fread (fBuffer, 1, size_t(size), fd) == size_t(size))) {
+				fBuffer[size] = fBuffer[size+1] = 0;
+				fData = fBuffer;
+				fSize = size_t(size) + 2;
+				ok = true;
+			}
+		}
+	}
+	fclose (fd);
+	if (!ok) release();
+	return ok;
+}
+
+//______________________________________________________________________________
+// UTF-16 to UTF-8 conversion: an UTF-16 unit takes at most 3 bytes in UTF-8
+// and a surrogate pair (2 units) takes 4 bytes
+void mappedfile::transcode (const unsigned char* src, size_t size, bool bigendian)
+{
+	char* buffer = (char*)malloc ((size / 2) * 3 + 2);
+	if (!buffer) {
+		release();
+		return;
+	}
+	unsigned char* dst = (unsigned char*)buffer;
+	const unsigned char* end = src + (size & ~size_t(1));
+	int hi = bigendian ? 0 : 1;
+	int lo = 1 - hi;
+	while (src < end) {
+		unsigned long c = (src[hi] << 8) | src[lo];
+		src += 2;
+		if (c < 0x80) {
+			*dst++ = (unsigned char)c;
+			continue;
+		}
+		if ((c >= 0xd800) && (c < 0xdc00) && (src < end)) {
+			unsigned long c2 = (src[hi] << 8) | src[lo];
+			if ((c2 >= 0xdc00) && (c2 < 0xe000)) {
+				src += 2;
+				c = 0x10000 + ((c - 0xd800) << 10) + (c2 - 0xdc00);
+				*dst++ = (unsigned char)(0xf0 | (c >> 18));
+				*dst++ = (unsigned char)(0x80 | ((c >> 12) & 0x3f));
+				*dst++ = (unsigned char)(0x80 | ((c >> 6) & 0x3f));
+				*dst++ = (unsigned char)(0x80 | (c & 0x3f));
+				continue;
+			}
+		}
+		if (c < 0x800) {
+			*dst++ = (unsigned char)(0xc0 | (c >> 6));
+			*dst++ = (unsigned char)(0x80 | (c & 0x3f));
+		}
+		else {
+			*dst++ = (unsigned char)(0xe0 | (c >> 12));
+			*dst++ = (unsigned char)(0x80 | ((c >> 6) & 0x3f));
+			*dst++ = (unsigned char)(0x80 | (c & 0x3f));
+		}
+	}
+	*dst++ = 0;
+	*dst++ = 0;
+	size_t n = dst - (unsigned char*)buffer;
+
+	release();
+	fBuffer = buffer;
+	fData = buffer;
+	fSize = n;
+}
+
+//______________________________________________________________________________
+bool readmappedfile (const char* file, reader* r)
+{
+	mappedfile data (file);
+	if (!data.data()) {
+		cerr << "can't open file " << file << endl;
+		return false;
+	}
+	return readmemory (data.data(), data.size(), r);
+}
+
+}
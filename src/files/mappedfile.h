@@ -0,0 +1,65 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __mappedfile__
+#define __mappedfile__
+
+#include <cstddef>
+
+class reader;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\internal
+\brief a file content made available in memory for the parser.
+
+	The file is memory mapped (copy on write) when possible, otherwise it is read
+	in a single block. The content may also be provided by a memory buffer. UTF-16 files (detected using their byte order mark) are
+	transcoded to UTF-8 in a single pass.
+	The content is terminated by 2 null chars, which are included in the size,
+	as expected by the scanner that operates directly on the data.
+*/
+class mappedfile
+{
+	char*	fData;		// the data passed to the parser
+	size_t	fSize;		// the data size, including the 2 null chars
+	void*	fMap;		// the mapped region when the file is mapped
+	size_t	fMapSize;	// the mapped region size
+	char*	fBuffer;	// an allocated buffer when the file is not mapped
+
+	bool	map		(const char* file);
+	bool	load	(const char* file);
+	void	decode ();
+	void	transcode (const unsigned char* src, size_t size, bool bigendian);
+	void	release ();
+
+	public:
+				 mappedfile (const char* file);
+				 //! takes the ownership of a buffer allocated with malloc, terminated by 2 null chars included in size
+				 mappedfile (char* buffer, size_t size);
+		virtual ~mappedfile ();
+
+		//! the file content, null when the file can't be opened or read
+		char*	data () const		{ return fData; }
+		//! the content size, including the 2 terminating null chars
+		size_t	size () const		{ return fSize; }
+};
+
+//! parses a file using a mappedfile, the scanner operates directly on the file data
+bool readmappedfile (const char* file, reader* r);
+
+}
+
+#endif
@@ -10,10 +10,13 @@
   research@grame.fr
 */
 
+#include <string.h>
+#include <fstream>
 #include <iostream>
+#include "xmlescape.h"
 #include "xmlfile.h"
-#include "xmlvisitor.h"
-#include "tree_browser.h"
+#include "xmlwriter.h"
+#include "zipfile.h"
 
 using namespace std; 
 using namespace MusicXML2; 
@@ -23,6 +26,15 @@ namespace MusicXML2
 //______________________________________________________________________________
 SXMLFile TXMLFile::create ()  { TXMLFile* o = new TXMLFile; assert(o!=0); return o; }
 
+//______________________________________________________________________________
+TXMLFile::~TXMLFile ()
+{
+	delete fXMLDecl;
+	delete fDocType;
+	fXMLTree = Sxmlelement();
+	if (fArena) fArena->release();
+}
+
 //______________________________________________________________________________
 TDocType::TDocType (const string start) : fStartElement(start), fPublic(true) 
 {
@@ -54,13 +66,61 @@ void TXMLDecl::print (ostream& s)
 }
 
 //______________________________________________________________________________
-void TXMLFile::print (ostream& stream) 
+void TXMLFile::print (ostream& stream, unsigned threads) 
+{
+	xmlwriter w(stream);
+	w.setThreads (threads);
+	w.write (*this);
+}
+
+//______________________________________________________________________________
+// a sink writing to a stream
+class streamsink : public xmlsink
+{
+	ostream& fStream;
+	public:
+				 streamsink (ostream& stream) : fStream(stream) {}
+		virtual ~streamsink() {}
+		void	write (const char* data, size_t size)	{ fStream.write (data, size); }
+};
+
+//______________________________________________________________________________
+void TXMLFile::writeMXL (xmlsink* out, const string& rootfile)
+{
+	static const char* kMimeType = "application/vnd.recordare.musicxml";
+
+	string container = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<container>\n    <rootfiles>\n        <rootfile full-path=\"";
+	xmlescape::append (container, rootfile.data(), rootfile.size(), true);
+	container += "\" media-type=\"application/vnd.recordare.musicxml+xml\"/>\n    </rootfiles>\n</container>\n";
+
+	zipwriter zip (out);
+	zip.add ("mimetype", kMimeType, strlen(kMimeType));		// first and stored, as required by the format
+	zip.add ("META-INF/container.xml", container.data(), container.size());
+	zip.open (rootfile);
+	{
+		xmlwriter w (&zip);
+		w.write (*this);
+	}
+	zip.finish();
+}
+
+//______________________________________________________________________________
+bool TXMLFile::writeMXL (const char* file)
 {
-	if (fXMLDecl) fXMLDecl->print(stream);
-	if (fDocType) fDocType->print(stream);
-	xmlvisitor v(stream);
-	tree_browser<xmlelement> browser(&v);
-	browser.browse(*elements());
+	ofstream out (file, ios::out | ios::binary);
+	if (!out.is_open()) return false;
+
+	string name (file);
+	size_t sep = name.find_last_of ("/\\");
+	if (sep != string::npos) name.erase (0, sep + 1);
+	size_t ext = name.rfind ('.');
+	if ((ext != string::npos) && ext) name.erase (ext);
+	if (name.empty()) name = "score";
+
+	streamsink sink (out);
+	writeMXL (&sink, name + ".xml");
+	out.close();
+	return !out.fail();
 }
 
 }
@@ -16,12 +16,15 @@
 #include <ostream>
 #include <string>
 #include "exports.h"
+#include "frozenxml.h"
 #include "xml.h"
 #include "ctree.h"
 
 namespace MusicXML2 
 {
 
+class xmlsink;
+
 //______________________________________________________________________________
 class EXP TXMLDecl {
 	std::string fVersion;
@@ -72,10 +75,11 @@ class EXP TXMLFile : public smartable
     TXMLDecl*             fXMLDecl;
     TDocType*             fDocType;
     Sxmlelement           fXMLTree;
+    arena*                fArena;		// the document elements arena, may be null
   
   protected:
-			 TXMLFile () : fXMLDecl(0), fDocType(0) {}
-    virtual ~TXMLFile () { delete fXMLDecl; delete fDocType; }
+			 TXMLFile () : fXMLDecl(0), fDocType(0), fArena(0) {}
+    virtual ~TXMLFile ();
     
   public:
     static SMARTP<TXMLFile> create();
@@ -88,8 +92,23 @@ class EXP TXMLFile : public smartable
     void 			set (Sxmlelement root)	{ fXMLTree = root; }
     void 			set (TXMLDecl * dec)	{ fXMLDecl = dec; }
     void 			set (TDocType * dt)		{ fDocType = dt; }
-
-    void 			print (std::ostream& s);
+    //! sets the arena of the document elements, it is released with the document
+    void 			set (arena * a)			{ fArena = a; }
+
+    /*! \brief writes the document
+    	\param threads the number of threads writing the root sub-elements concurrently (e.g. the parts),
+    		0 for the number of hardware threads, see xmlwriter::setThreads
+    */
+    void 			print (std::ostream& s, unsigned threads = 1);
+    /*! \brief writes the document as a compressed MusicXML file (.mxl)
+    	The score is named after the file in the archive (e.g. 'song.xml' for 'song.mxl').
+    	\return false when the file can't be written
+    */
+    bool 			writeMXL (const char* file);
+    //! writes the document as a compressed MusicXML archive to a sink, using \c rootfile as the score name
+    void 			writeMXL (xmlsink* out, const std::string& rootfile = "score.xml");
+    //! builds a read only flattened representation of the document elements
+    Sfrozenxml		freeze ()				{ return frozenxml::create (fXMLTree); }
 };
 typedef SMARTP<TXMLFile> SXMLFile;
 
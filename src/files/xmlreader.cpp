@@ -16,7 +16,10 @@
 
 #include <iostream>
 #include "xmlreader.h"
+#include "xmlescape.h"
 #include "factory.h"
+#include "mappedfile.h"
+#include "zipfile.h"
 
 using namespace std;
 
@@ -35,10 +38,23 @@ bool readbuffer (const char * buffer, reader * r);
 #define debug(str,val)
 #endif
 
+//_______________________________________________________________________________
+// gives the arena of the current file in arena mode
+// the arena keeps the elements until the document is released: it is not used with
+// a measure handler, since the streamed measures would be retained as well
+arena* xmlreader::fileArena ()
+{
+	if (!fUseArena || fMeasureHandler) return 0;
+	arena* a = new arena;
+	fFile->set (a);
+	return a;
+}
+
 //_______________________________________________________________________________
 SXMLFile xmlreader::readbuff(const char* buffer)
 {
 	fFile = TXMLFile::create();
+	arena::scope scope (fileArena());
 	debug("read buffer", '-');
 	return readbuffer (buffer, this) ? fFile : 0;
 }
@@ -47,6 +63,7 @@ SXMLFile xmlreader::readbuff(const char* buffer)
 SXMLFile xmlreader::read(const char* file)
 {
 	fFile = TXMLFile::create();
+	arena::scope scope (fileArena());
 	debug("read", file);
 	return readfile (file, this) ? fFile : 0;
 }
@@ -55,16 +72,43 @@ SXMLFile xmlreader::read(const char* file)
 SXMLFile xmlreader::read(FILE* file)
 {
 	fFile = TXMLFile::create();
+	arena::scope scope (fileArena());
 	return readstream (file, this) ? fFile : 0;
 }
 
+//_______________________________________________________________________________
+SXMLFile xmlreader::readMapped(const char* file)
+{
+	fFile = TXMLFile::create();
+	arena::scope scope (fileArena());
+	debug("read mapped", file);
+	return readmappedfile (file, this) ? fFile : 0;
+}
+
+//_______________________________________________________________________________
+SXMLFile xmlreader::readMXL(const char* file)
+{
+	fFile = TXMLFile::create();
+	arena::scope scope (fileArena());
+	debug("read mxl", file);
+	return readmxlfile (file, this) ? fFile : 0;
+}
+
+//_______________________________________________________________________________
+// with a measure handler, a part content is not retained (comments between measures are lost)
+bool xmlreader::streamed (const Sxmlelement& elt) const
+{
+	return fMeasureHandler && (elt->getType() == k_part);
+}
+
 //_______________________________________________________________________________
 void xmlreader::newComment (const char* comment)
 {
 	Sxmlelement elt = factory::instance().create("comment");
 	elt->setValue(comment);
+	elt->setOrder(++fOrder);
 	// comments outside the xml hierarchy are lost
-	if (fStack.size()) fStack.top()->push(elt);
+	if (fStack.size() && !streamed(fStack.top())) fStack.top()->push(std::move(elt));
 }
 
 //_______________________________________________________________________________
@@ -72,8 +116,9 @@ void xmlreader::newProcessingInstruction (const char* pi)
 {
 	Sxmlelement elt = factory::instance().create("pi");
 	elt->setValue(pi);
+	elt->setOrder(++fOrder);
 	// processing instructions outside the xml hierarchy are lost
-	if (fStack.size()) fStack.top()->push(elt);
+	if (fStack.size() && !streamed(fStack.top())) fStack.top()->push(std::move(elt));
 }
 
 //_______________________________________________________________________________
@@ -85,12 +130,16 @@ bool xmlreader::newElement (const char* eltName)
 	if (!fFile->elements()) {
 	debug("first element", eltName);
 		fFile->set(elt);
+		fStack = stack<Sxmlelement>();	// may be left by a previous stopped parsing
+		fStopped = false;
+		fOrder = 0;
 	}
 	else {
 	debug("push element", eltName);
 		fStack.top()->push(elt);
 	}
-	fStack.push(elt);
+	elt->setOrder(++fOrder);
+	fStack.push(std::move(elt));
 	return true;
 }
 
@@ -98,23 +147,28 @@ bool xmlreader::newElement (const char* eltName)
 bool xmlreader::endElement (const char* eltName)
 {
 	debug("endElement", eltName);
-	Sxmlelement top = fStack.top();
+	Sxmlelement top = std::move(fStack.top());
 	fStack.pop();
-	return top->getName() == eltName;
+	if (top->getName() != eltName) return false;
+	if ((top->getType() == k_measure) && fStack.size() && streamed(fStack.top())) {
+		S_part part = static_cast<musicxml<k_part>*>((xmlelement*)fStack.top());
+		S_measure measure = static_cast<musicxml<k_measure>*>((xmlelement*)top);
+		part->pop();
+		fStopped = !fMeasureHandler->measure (part, measure);
+		return !fStopped;
+	}
+	return true;
 }
 
 //_______________________________________________________________________________
 bool xmlreader::newAttribute (const char* name, const char *value)
 {
 	debug("newAttribute", name);
-	Sxmlattribute attr = xmlattribute::create();
-	if (attr) {
-		attr->setName(name);
-		attr->setValue(value);
-		fStack.top()->add(attr);
-		return true;
-	}
-	return false;
+	string decoded;
+	if (xmlescape::decode (value, decoded))
+		fStack.top()->add(nametable::intern(name), decoded);
+	else fStack.top()->add(nametable::intern(name), value);
+	return true;
 }
 
 //_______________________________________________________________________________
@@ -139,13 +193,16 @@ bool xmlreader::docType (const char* start, bool status, const char *pub, const
 void xmlreader::setValue (const char* value)
 {
 	debug("setValue", value);
-	fStack.top()->setValue(value);
+	string decoded;
+	if (xmlescape::decode (value, decoded))
+		fStack.top()->setValue(decoded);
+	else fStack.top()->setValue(value);
 }
 
 //_______________________________________________________________________________
 void xmlreader::error (const char* s, int lineno)
 {
-	cerr << s  << " on line " << lineno << endl;
+	if (!fStopped) cerr << s  << " on line " << lineno << endl;
 }
 
 }
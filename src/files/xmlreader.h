@@ -18,23 +18,78 @@
 #include "exports.h"
 #include "xmlfile.h"
 #include "reader.h"
+#include "typedefs.h"
 
 namespace MusicXML2 
 {
 
 //______________________________________________________________________________
+/*!
+\brief receives the measures of a score-partwise one at a time.
+
+	\see xmlreader::setMeasureHandler
+*/
+class EXP measurehandler
+{
+	public:
+		virtual ~measurehandler() {}
+
+		/*! \brief called with each completed measure
+			\param part the enclosing part, its measures are not available
+			\param measure the measure, detached from the part
+			\return false to stop the parsing
+		*/
+		virtual bool measure (S_part& part, S_measure& measure) = 0;
+};
+
+//______________________________________________________________________________
+/*!
+\brief builds a xml tree from a file, a stream or a buffer.
+
+	The parser state is thread local: distinct xmlreader instances
+	can be used concurrently from different threads. The reads can't be nested
+	on a thread: a read made from a measure handler, while the parser is in use,
+	fails with an error.
+*/
 class EXP xmlreader : public reader
 { 
 	std::stack<Sxmlelement>	fStack;
 	SXMLFile				fFile;
+	measurehandler*			fMeasureHandler;
+	bool					fStopped;		// parsing stopped by the measure handler
+	bool					fUseArena;
+	long					fOrder;			// the document order of the last created element
 
 	public:
-				 xmlreader() {}
+				 xmlreader(measurehandler* h = 0) : fMeasureHandler(h), fStopped(false), fUseArena(false), fOrder(0) {}
 		virtual ~xmlreader() {}
 		
 		SXMLFile readbuff(const char* file);
 		SXMLFile read(const char* file);
 		SXMLFile read(FILE* file);
+		//! reads a file using a memory mapping: the scanner operates directly on the mapped data
+		SXMLFile readMapped(const char* file);
+		//! reads a compressed MusicXML file (.mxl): the root file is decompressed in memory
+		SXMLFile readMXL(const char* file);
+
+		/*! \brief sets a measure handler (0 to remove it)
+
+			When a handler is set, the measures of a score-partwise are given to the handler
+			as soon as they are completed and are next released: they are not part of the
+			resulting tree, the memory use is then proportional to the size of a measure.
+			When the handler stops the parsing, the read methods return 0.
+		*/
+		void	setMeasureHandler (measurehandler* h)	{ fMeasureHandler = h; }
+
+		/*! \brief sets the arena mode
+
+			In arena mode, the elements and attributes of a document are allocated
+			from an arena and are released in one shot with the document. The elements
+			still referenced when the document is deleted remain valid (see arena).
+			The arena mode is ignored when a measure handler is set: the streamed measures
+			are released as they are processed, to keep the memory use bounded.
+		*/
+		void	useArena (bool state)		{ fUseArena = state; }
 
 		bool	xmlDecl (const char* version, const char *encoding, int standalone);
 		bool	docType (const char* start, bool status, const char *pub, const char *sys);
@@ -46,6 +101,10 @@ class EXP xmlreader : public reader
 		void	setValue (const char* value);
 		bool	endElement (const char* eltName);
 		void	error (const char* s, int lineno);
+
+	private:
+		bool	streamed (const Sxmlelement& elt) const;
+		arena*		fileArena ();
 };
 
 }
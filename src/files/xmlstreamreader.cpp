@@ -0,0 +1,151 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <iostream>
+#include <string.h>
+#include "xmlstreamreader.h"
+#include "elements.h"
+#include "factory.h"
+#include "mappedfile.h"
+#include "xmlescape.h"
+#include "zipfile.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+extern "C" {
+bool readfile   (const char * file, reader * r);
+bool readstream (FILE * file, reader * r);
+bool readbuffer (const char * buffer, reader * r);
+}
+
+//_______________________________________________________________________________
+void xmlhandler::error (const char* msg, int lineno)
+{
+	cerr << msg  << " on line " << lineno << endl;
+}
+
+//_______________________________________________________________________________
+void xmlstreamreader::reset ()
+{
+	fTypes.clear();
+	fOffsets.clear();
+	fNames.clear();
+}
+
+//_______________________________________________________________________________
+bool xmlstreamreader::readbuff(const char* buffer)
+{
+	reset();
+	return readbuffer (buffer, this);
+}
+
+bool xmlstreamreader::read(const char* file)
+{
+	reset();
+	return readfile (file, this);
+}
+
+bool xmlstreamreader::read(FILE* file)
+{
+	reset();
+	return readstream (file, this);
+}
+
+bool xmlstreamreader::readMapped(const char* file)
+{
+	reset();
+	return readmappedfile (file, this);
+}
+
+bool xmlstreamreader::readMXL(const char* file)
+{
+	reset();
+	return readmxlfile (file, this);
+}
+
+//_______________________________________________________________________________
+bool xmlstreamreader::xmlDecl (const char* version, const char *encoding, int standalone)
+{
+	fHandler->xmlDecl (version, encoding, standalone);
+	return true;
+}
+
+bool xmlstreamreader::docType (const char* start, bool status, const char *pub, const char *sys)
+{
+	fHandler->docType (start, status, pub, sys);
+	return true;
+}
+
+void xmlstreamreader::newComment (const char* comment)
+{
+	fHandler->comment (comment);
+}
+
+void xmlstreamreader::newProcessingInstruction (const char* pi)
+{
+	fHandler->processingInstruction (pi);
+}
+
+//_______________________________________________________________________________
+bool xmlstreamreader::newElement (const char* eltName)
+{
+	int type = factory::instance().getType (eltName);
+	fTypes.push_back (type);
+	fOffsets.push_back (fNames.size());
+	fNames.append (eltName);
+	fNames.push_back (0);
+	return fHandler->startElement (type, eltName);
+}
+
+//_______________________________________________________________________________
+bool xmlstreamreader::endElement (const char* eltName)
+{
+	if (fTypes.empty()) return false;
+	int type = fTypes.back();
+	size_t offset = fOffsets.back();
+	bool match = strcmp (fNames.c_str() + offset, eltName) == 0;
+	fTypes.pop_back();
+	fOffsets.pop_back();
+	fNames.resize (offset);
+	return match && fHandler->endElement (type, eltName);
+}
+
+//_______________________________________________________________________________
+bool xmlstreamreader::newAttribute (const char* name, const char *value)
+{
+	if (!fTypes.size()) return false;
+	string decoded;
+	if (xmlescape::decode (value, decoded))
+		return fHandler->attribute (fTypes.back(), name, decoded.c_str());
+	return fHandler->attribute (fTypes.back(), name, value);
+}
+
+//_______________________________________________________________________________
+void xmlstreamreader::setValue (const char* value)
+{
+	if (!fTypes.size()) return;
+	string decoded;
+	if (xmlescape::decode (value, decoded))
+		fHandler->value (fTypes.back(), decoded.c_str());
+	else fHandler->value (fTypes.back(), value);
+}
+
+//_______________________________________________________________________________
+void xmlstreamreader::error (const char* s, int lineno)
+{
+	fHandler->error (s, lineno);
+}
+
+}
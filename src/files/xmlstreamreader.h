@@ -0,0 +1,100 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __xmlstreamreader__
+#define __xmlstreamreader__
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "exports.h"
+#include "reader.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\brief the events generated by a xmlstreamreader.
+
+	Elements are identified by their type (as defined in elements.h) and by their name.
+	Elements not part of the MusicXML format have the kNoElement type.
+	The strings passed to the callbacks are only valid during the call.
+	The default implementation ignores all the events.
+*/
+class EXP xmlhandler
+{
+	public:
+				 xmlhandler() {}
+		virtual ~xmlhandler() {}
+
+		virtual void	xmlDecl (const char* version, const char *encoding, int standalone) {}
+		virtual void	docType (const char* start, bool status, const char *pub, const char *sys) {}
+		virtual void	comment (const char* comment) {}
+		virtual void	processingInstruction (const char* pi) {}
+
+		//! an element start tag, returning false stops the parsing
+		virtual bool	startElement (int type, const char* name)	{ return true; }
+		//! an attribute of the current element of type \c type, returning false stops the parsing
+		virtual bool	attribute (int type, const char* name, const char* value)	{ return true; }
+		//! the value of the current element of type \c type
+		virtual void	value (int type, const char* value) {}
+		//! an element end tag, returning false stops the parsing
+		virtual bool	endElement (int type, const char* name)		{ return true; }
+		virtual void	error (const char* msg, int lineno);
+};
+
+//______________________________________________________________________________
+/*!
+\brief a SAX like reader: parses a file and forwards the parsing events to a xmlhandler.
+
+	Contrary to xmlreader, no memory tree is built: the reader only maintains the stack
+	of the currently opened elements. As for xmlreader, the reads can't be nested on a
+	thread: a read made from the handler callbacks fails with an error.
+*/
+class EXP xmlstreamreader : public reader
+{
+	xmlhandler*			fHandler;
+	std::vector<int>	fTypes;			// the opened elements types
+	std::vector<size_t>	fOffsets;		// the opened elements names offsets in fNames
+	std::string			fNames;			// the opened elements names, null separated
+
+	public:
+				 xmlstreamreader(xmlhandler* handler) : fHandler(handler) {}
+		virtual ~xmlstreamreader() {}
+
+		bool	readbuff(const char* buffer);
+		bool	read(const char* file);
+		bool	read(FILE* file);
+		//! reads a file using a memory mapping: the scanner operates directly on the mapped data
+		bool	readMapped(const char* file);
+		//! reads a compressed MusicXML file (.mxl): the root file is decompressed in memory
+		bool	readMXL(const char* file);
+
+		bool	xmlDecl (const char* version, const char *encoding, int standalone);
+		bool	docType (const char* start, bool status, const char *pub, const char *sys);
+
+		void	newComment (const char* comment);
+		void	newProcessingInstruction (const char* pi);
+		bool	newElement (const char* eltName);
+		bool	newAttribute (const char* eltName, const char *val);
+		void	setValue (const char* value);
+		bool	endElement (const char* eltName);
+		void	error (const char* s, int lineno);
+
+	private:
+		void	reset ();
+};
+
+}
+
+#endif
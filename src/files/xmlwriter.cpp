@@ -0,0 +1,210 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "elements.h"
+#include "xmlescape.h"
+#include "xmlfile.h"
+#include "xmlwriter.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+// the indentation of 32 levels, deeper levels are written in several steps
+static const char	kIndent[] = "\n"
+	"                                                                "
+	"                                                                ";
+static const int	kIndentLevels = (sizeof(kIndent) - 2) / 4;
+
+// the minimum count of elements written concurrently: smaller trees are written
+// sequentially, the threads creation would cost more than it saves
+static const size_t	kConcurrentSize = 10000;
+
+//______________________________________________________________________________
+xmlwriter::xmlwriter (ostream& out, bool compact, size_t bufferSize)
+	: fStream(&out), fSink(0), fBuffer(fOwnBuffer), fLimit(bufferSize ? bufferSize : 1), fCompact(compact), fThreads(1)
+{
+	fBuffer.reserve (fLimit + 1024);
+}
+
+xmlwriter::xmlwriter (xmlsink* out, bool compact, size_t bufferSize)
+	: fStream(0), fSink(out), fBuffer(fOwnBuffer), fLimit(bufferSize ? bufferSize : 1), fCompact(compact), fThreads(1)
+{
+	fBuffer.reserve (fLimit + 1024);
+}
+
+xmlwriter::xmlwriter (string& out, bool compact)
+	: fStream(0), fSink(0), fBuffer(out), fLimit(0), fCompact(compact), fThreads(1)
+{
+}
+
+xmlwriter::~xmlwriter ()	{ flush(); }
+
+//______________________________________________________________________________
+void xmlwriter::flush ()
+{
+	if (!fLimit || fBuffer.empty()) return;
+	if (fStream) fStream->write (fBuffer.data(), fBuffer.size());
+	else if (fSink) fSink->write (fBuffer.data(), fBuffer.size());
+	fBuffer.clear();
+}
+
+//______________________________________________________________________________
+void xmlwriter::newline (int depth)
+{
+	if (fCompact) return;
+	int levels = (depth < kIndentLevels) ? depth : kIndentLevels;
+	put (kIndent, 1 + levels * 4);
+	for (depth -= levels; depth > 0; depth -= levels) {
+		levels = (depth < kIndentLevels) ? depth : kIndentLevels;
+		put (kIndent + 1, levels * 4);
+	}
+}
+
+//______________________________________________________________________________
+void xmlwriter::putEscaped (const string& s, bool attribute)
+{
+	if (xmlescape::find (s.data(), s.size(), attribute) == s.size()) put (s);
+	else xmlescape::append (fBuffer, s.data(), s.size(), attribute);
+}
+
+//______________________________________________________________________________
+// checks that a tree has at least size elements, without browsing it further
+static bool larger (const xmlelement* elt, size_t size)
+{
+	for (xmlelement::walker w (const_cast<xmlelement*>(elt)); w != xmlelement::walker(); ++w)
+		if (!--size) return true;
+	return false;
+}
+
+//______________________________________________________________________________
+void xmlwriter::element (const xmlelement* elt, int depth)
+{
+	newline (depth);
+	switch (elt->getType()) {
+		case kComment:
+			put ("<!--", 4); put (elt->getValue()); put ("-->", 3);
+			return;
+		case kProcessingInstruction:
+			put ("<?", 2); put (elt->getValue()); put ("?>", 2);
+			return;
+	}
+
+	const string& name = elt->getName();
+	put ('<'); put (name);
+	const vector<xmlattribute::slot>& attributes = elt->attributeSlots();
+	for (vector<xmlattribute::slot>::const_iterator a = attributes.begin(); a != attributes.end(); a++) {
+		put (' '); put (*a->name); put ("=\"", 2); putEscaped (a->value, true); put ('"');
+	}
+	if (elt->empty()) {
+		put ("/>", 2);		// element is empty, we can directly close it
+	}
+	else {
+		put ('>');
+		putEscaped (elt->getValue(), false);
+		if (elt->size()) {
+			if ((depth == 0) && (fThreads != 1) && (elt->size() > 1) && larger (elt, kConcurrentSize))
+				concurrent (elt, depth + 1);
+			else for (ctree<xmlelement>::branchs::const_iterator i = elt->elements().begin(); i != elt->elements().end(); i++)
+				element (*i, depth + 1);
+			newline (depth);
+		}
+		put ("</", 2); put (name); put ('>');
+	}
+	if (fLimit && (fBuffer.size() >= fLimit)) flush();
+}
+
+//______________________________________________________________________________
+// the sub-elements shared by the threads: each thread takes the next one to write
+struct xmlwriter::tasks {
+	vector<const xmlelement*>	elements;
+	vector<string>				buffers;
+	atomic<size_t>				next;
+	int							depth;
+	bool						compact;
+};
+
+void xmlwriter::worker (tasks* t)
+{
+	for (size_t i = t->next++; i < t->elements.size(); i = t->next++) {
+		xmlwriter w (t->buffers[i], t->compact);
+		w.element (t->elements[i], t->depth);
+	}
+}
+
+//______________________________________________________________________________
+void xmlwriter::concurrent (const xmlelement* elt, int depth)
+{
+	const ctree<xmlelement>::branchs& elts = elt->elements();
+	unsigned count = fThreads ? fThreads : thread::hardware_concurrency();
+	if (count > elts.size()) count = unsigned(elts.size());
+	if (count < 2) {
+		for (ctree<xmlelement>::branchs::const_iterator i = elts.begin(); i != elts.end(); i++)
+			element (*i, depth);
+		return;
+	}
+
+	tasks t;
+	for (ctree<xmlelement>::branchs::const_iterator i = elts.begin(); i != elts.end(); i++)
+		t.elements.push_back (*i);
+	t.buffers.resize (elts.size());
+	t.next = 0;
+	t.depth = depth;
+	t.compact = fCompact;
+
+	vector<thread> threads;
+	for (unsigned n = 1; n < count; n++) {
+		try { threads.push_back (thread (worker, &t)); }
+		catch (...) { break; }		// the remaining sub-elements are written by the calling thread
+	}
+	worker (&t);
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+
+	for (size_t i = 0; i < t.buffers.size(); i++) {
+		put (t.buffers[i]);
+		string().swap (t.buffers[i]);
+		if (fLimit && (fBuffer.size() >= fLimit)) flush();
+	}
+}
+
+//______________________________________________________________________________
+void xmlwriter::write (const xmlelement* elt)
+{
+	if (elt) element (elt, 0);
+}
+
+//______________________________________________________________________________
+void xmlwriter::write (TXMLFile& file)
+{
+	TXMLDecl* decl = file.getXMLDecl();
+	if (decl) {
+		put ("<?xml version=\""); put (decl->getVersion()); put ('"');
+		if (!decl->getEncoding().empty())		{ put (" encoding=\""); put (decl->getEncoding()); put ('"'); }
+		if (decl->getStandalone() != TXMLDecl::kundefined)	put (decl->getStandalone() ? " standalone=\"yes\"" : " standalone=\"no\"");
+		put ("?>", 2);
+	}
+	TDocType* doctype = file.getDocType();
+	if (doctype) {
+		put ("\n<!DOCTYPE "); put (doctype->getStartElement());
+		put (doctype->getPublic() ? " PUBLIC " : " SYSTEM ");
+		put ('"'); put (doctype->getPubLitteral()); put ("\"\n\t\t\t\""); put (doctype->getSysLitteral()); put ("\">");
+	}
+	write (file.elements());
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __xmlwriter__
+#define __xmlwriter__
+
+#include <ostream>
+#include <string>
+
+#include "exports.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+class TXMLFile;
+
+//______________________________________________________________________________
+/*!
+\brief an xml output destination, to be implemented by clients.
+*/
+class EXP xmlsink
+{
+	public:
+		virtual ~xmlsink() {}
+		//! called with the serialized data, as blocks of the writer buffer size
+		virtual void write (const char* data, size_t size) = 0;
+};
+
+//______________________________________________________________________________
+/*!
+\brief serializes a document or an elements tree.
+
+	The output is built in a contiguous buffer, which is written to the destination
+	(a stream or an xmlsink) when full and when the writer is flushed or deleted.
+	When the destination is a string, the output is directly appended to the string.
+
+	The indented output is identical to the output of the xmlvisitor (each element
+	on a new line, indented by 4 spaces per level), but without a flush per line.
+	The compact output has no line breaks nor indentation between the elements.
+
+	The sub-elements of the written root (e.g. the parts of a partwise score) can be
+	written concurrently (see setThreads): each one is written to its own buffer by
+	a pool of threads and the buffers are output in order, the output is identical
+	to the sequential output. The elements tree must not be modified meanwhile.
+	Small trees are always written sequentially: the threads are created for each
+	write and would cost more than they save.
+*/
+class EXP xmlwriter
+{
+	public:
+		enum { kBufferSize = 256 * 1024 };
+
+				 xmlwriter (std::ostream& out, bool compact = false, size_t bufferSize = kBufferSize);
+				 xmlwriter (xmlsink* out, bool compact = false, size_t bufferSize = kBufferSize);
+				 xmlwriter (std::string& out, bool compact = false);
+		virtual ~xmlwriter();
+
+		//! writes the document: the xml declaration, the document type and the elements
+		void	write (TXMLFile& file);
+		//! writes an elements tree
+		void	write (const xmlelement* elt);
+		//! writes the buffered output to the destination
+		void	flush ();
+		/*! \brief sets the number of threads used to write the root sub-elements
+			\param n the threads count, 0 for the number of hardware threads, 1 (the default) to write sequentially
+		*/
+		void	setThreads (unsigned n)		{ fThreads = n; }
+
+	private:
+		std::ostream*	fStream;
+		xmlsink*		fSink;
+		std::string		fOwnBuffer;
+		std::string&	fBuffer;		// the own buffer or the destination string
+		size_t			fLimit;			// the buffer size that triggers a flush, 0 when writing to a string
+		bool			fCompact;
+		unsigned		fThreads;
+
+		void	put (const char* s, size_t size)	{ fBuffer.append (s, size); }
+		void	put (const char* s)					{ fBuffer.append (s); }
+		void	put (const std::string& s)			{ fBuffer.append (s); }
+		void	put (char c)						{ fBuffer.push_back (c); }
+		void	putEscaped (const std::string& s, bool attribute);
+		void	newline (int depth);
+		void	element (const xmlelement* elt, int depth);
+		void	concurrent (const xmlelement* elt, int depth);
+
+		struct tasks;
+		static void	worker (tasks* t);
+
+				 xmlwriter (const xmlwriter&);				// not copyable
+		xmlwriter&	operator= (const xmlwriter&);
+};
+
+}
+
+#endif
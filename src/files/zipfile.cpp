@@ -0,0 +1,330 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <iostream>
+
+#include "deflate.h"
+#include "reader.h"
+#include "xmlescape.h"
+#include "zipfile.h"
+
+using namespace std;
+
+extern "C" {
+bool readmemory (char * buffer, size_t size, reader * r);
+}
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// zip format constants and little endian readers
+enum {
+	kLocalHeaderSig = 0x04034b50, kLocalHeaderSize = 30,
+	kCentralHeaderSig = 0x02014b50, kCentralHeaderSize = 46,
+	kEndOfDirSig = 0x06054b50, kEndOfDirSize = 22,
+	kDataDescriptorSig = 0x08074b50,
+	kStored = 0, kDeflated = 8,
+	kVersion = 20, kStreamedFlag = 8		// the crc and sizes follow the entry data
+};
+
+static inline unsigned read16 (const unsigned char* p)	{ return p[0] | (p[1] << 8); }
+static inline unsigned long read32 (const unsigned char* p)
+	{ return (unsigned long)p[0] | ((unsigned long)p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24); }
+static inline void write16 (string& s, unsigned v)	{ s.push_back (char(v & 0xff)); s.push_back (char((v >> 8) & 0xff)); }
+static inline void write32 (string& s, unsigned long v)	{ write16 (s, unsigned(v & 0xffff)); write16 (s, unsigned((v >> 16) & 0xffff)); }
+
+//______________________________________________________________________________
+// a reader collecting the first rootfile full-path from META-INF/container.xml
+class containerreader : public reader
+{
+	bool fInRootfile;
+	public:
+		string fRootfile;
+
+				 containerreader() : fInRootfile(false) {}
+		virtual ~containerreader() {}
+
+		bool	xmlDecl (const char* version, const char *encoding, int standalone)	{ return true; }
+		bool	docType (const char* start, bool status, const char *pub, const char *sys) { return true; }
+		bool	newElement (const char* eltName)	{ fInRootfile = !strcmp(eltName, "rootfile"); return true; }
+		bool	newAttribute (const char* name, const char *val) {
+			if (fInRootfile && fRootfile.empty() && !strcmp(name, "full-path")) {
+				if (!xmlescape::decode (val, fRootfile)) fRootfile = val;
+			}
+			return true;
+		}
+		void	setValue (const char* value)		{}
+		bool	endElement (const char* eltName)	{ fInRootfile = false; return true; }
+		void	error (const char* s, int lineno)	{}
+};
+
+//______________________________________________________________________________
+zipfile::zipfile (const char* file) : fData (file)
+{
+	if (!readDirectory ()) fEntries.clear();
+}
+
+//______________________________________________________________________________
+bool zipfile::readDirectory ()
+{
+	if (!fData.data()) return false;
+	const unsigned char* data = (const unsigned char*)fData.data();
+	size_t size = fData.size() - 2;
+	if (size < kEndOfDirSize) return false;
+
+	// look for the end of central directory record, it may be followed by a comment
+	size_t eod = size - kEndOfDirSize;
+	size_t limit = (eod > 0xffff) ? eod - 0xffff : 0;
+	while (read32 (data + eod) != kEndOfDirSig) {
+		if (eod == limit) return false;
+		eod--;
+	}
+	size_t count  = read16 (data + eod + 10);
+	size_t offset = read32 (data + eod + 16);
+
+	for (size_t i = 0; i < count; i++) {
+		if ((offset + kCentralHeaderSize > size) || (read32 (data + offset) != kCentralHeaderSig))
+			return false;
+		const unsigned char* h = data + offset;
+		size_t namelen = read16 (h + 28);
+		size_t next = offset + kCentralHeaderSize + namelen + read16 (h + 30) + read16 (h + 32);
+		if (next > size) return false;
+
+		entry e;
+		e.method			= int(read16 (h + 10));
+		e.crc				= read32 (h + 16);
+		e.compressedSize	= read32 (h + 20);
+		e.size				= read32 (h + 24);
+		e.offset			= read32 (h + 42);
+		e.name.assign ((const char*)h + kCentralHeaderSize, namelen);
+		fEntries.push_back (e);
+		offset = next;
+	}
+	return true;
+}
+
+//______________________________________________________________________________
+const zipfile::entry* zipfile::find (const string& name) const
+{
+	for (vector<entry>::const_iterator i = fEntries.begin(); i != fEntries.end(); i++)
+		if (i->name == name) return &(*i);
+	return 0;
+}
+
+//______________________________________________________________________________
+char* zipfile::extract (const entry& e, size_t& size) const
+{
+	const unsigned char* data = (const unsigned char*)fData.data();
+	size_t datasize = fData.size() - 2;
+	if ((e.offset + kLocalHeaderSize > datasize) || (read32 (data + e.offset) != kLocalHeaderSig))
+		return 0;
+	const unsigned char* h = data + e.offset;
+	size_t start = e.offset + kLocalHeaderSize + read16 (h + 26) + read16 (h + 28);
+	if ((start + e.compressedSize > datasize) || (start + e.compressedSize < start)) return 0;
+
+	char* buffer = (char*)malloc (e.size + 2);
+	if (!buffer) return 0;
+	bool ok = false;
+	if (e.method == kStored) {
+		ok = (e.compressedSize == e.size);
+		if (ok) memcpy (buffer, data + start, e.size);
+	}
+	else if (e.method == kDeflated)
+		ok = inflate (data + start, e.compressedSize, (unsigned char*)buffer, e.size);
+	if (ok) ok = (crc32 (0, (const unsigned char*)buffer, e.size) == e.crc);
+	if (!ok) {
+		free (buffer);
+		return 0;
+	}
+	buffer[e.size] = buffer[e.size + 1] = 0;
+	size = e.size;
+	return buffer;
+}
+
+//______________________________________________________________________________
+string zipfile::rootfile () const
+{
+	const entry* container = find ("META-INF/container.xml");
+	if (container) {
+		size_t size;
+		char* buffer = extract (*container, size);
+		if (buffer) {
+			containerreader r;
+			readmemory (buffer, size + 2, &r);
+			free (buffer);
+			if (!r.fRootfile.empty()) return r.fRootfile;
+		}
+	}
+	// no container: look for the first xml file outside of META-INF
+	for (vector<entry>::const_iterator i = fEntries.begin(); i != fEntries.end(); i++) {
+		const string& name = i->name;
+		if ((name.size() > 4) && (name.compare (name.size() - 4, 4, ".xml") == 0) && (name.compare (0, 9, "META-INF/") != 0))
+			return name;
+	}
+	return "";
+}
+
+//______________________________________________________________________________
+bool readmxlfile (const char* file, reader* r)
+{
+	zipfile zip (file);
+	if (zip.entries().empty()) {
+		cerr << "can't read compressed file " << file << endl;
+		return false;
+	}
+	string root = zip.rootfile();
+	const zipfile::entry* e = zip.find (root);
+	size_t size;
+	char* buffer = e ? zip.extract (*e, size) : 0;
+	if (!buffer) {
+		cerr << "can't extract \"" << root << "\" from " << file << endl;
+		return false;
+	}
+	mappedfile data (buffer, size + 2);
+	return readmemory (data.data(), data.size(), r);
+}
+
+//______________________________________________________________________________
+// zipwriter
+//______________________________________________________________________________
+zipwriter::zipwriter (xmlsink* out) : fOut(out), fOffset(0), fTime(0), fDate(0), fDeflater(0)
+{
+	time_t now = time(0);
+	struct tm* t = localtime (&now);
+	if (t && (t->tm_year >= 80)) {
+		fTime = (t->tm_hour << 11) | (t->tm_min << 5) | (t->tm_sec >> 1);
+		fDate = ((t->tm_year - 80) << 9) | ((t->tm_mon + 1) << 5) | t->tm_mday;
+	}
+	else fDate = (1 << 5) | 1;		// 1980-01-01
+}
+
+zipwriter::~zipwriter ()	{ delete fDeflater; }
+
+//______________________________________________________________________________
+void zipwriter::flush ()
+{
+	if (fBuffer.empty()) return;
+	fOut->write (fBuffer.data(), fBuffer.size());
+	fOffset += fBuffer.size();
+	fBuffer.clear();
+}
+
+//______________________________________________________________________________
+void zipwriter::header (const zipfile::entry& e, bool central)
+{
+	write32 (fBuffer, central ? kCentralHeaderSig : kLocalHeaderSig);
+	if (central) write16 (fBuffer, kVersion);
+	write16 (fBuffer, kVersion);
+	write16 (fBuffer, (e.method == kDeflated) ? kStreamedFlag : 0);
+	write16 (fBuffer, e.method);
+	write16 (fBuffer, fTime);
+	write16 (fBuffer, fDate);
+	bool known = central || (e.method == kStored);
+	write32 (fBuffer, known ? e.crc : 0);
+	write32 (fBuffer, known ? e.compressedSize : 0);
+	write32 (fBuffer, known ? e.size : 0);
+	write16 (fBuffer, unsigned(e.name.size()));
+	write16 (fBuffer, 0);				// extra field length
+	if (central) {
+		write16 (fBuffer, 0);			// comment length
+		write16 (fBuffer, 0);			// disk number
+		write16 (fBuffer, 0);			// internal attributes
+		write32 (fBuffer, 0);			// external attributes
+		write32 (fBuffer, e.offset);
+	}
+	fBuffer += e.name;
+}
+
+//______________________________________________________________________________
+void zipwriter::add (const string& name, const char* data, size_t size)
+{
+	close();
+	zipfile::entry e;
+	e.name = name;
+	e.method = kStored;
+	e.crc = crc32 (0, (const unsigned char*)data, size);
+	e.compressedSize = e.size = size;
+	e.offset = fOffset + fBuffer.size();
+	header (e, false);
+	fBuffer.append (data, size);
+	fEntries.push_back (e);
+	flush();
+}
+
+//______________________________________________________________________________
+void zipwriter::open (const string& name)
+{
+	close();
+	zipfile::entry e;
+	e.name = name;
+	e.method = kDeflated;
+	e.crc = 0;
+	e.compressedSize = e.size = 0;
+	e.offset = fOffset + fBuffer.size();
+	header (e, false);
+	fEntries.push_back (e);
+	flush();
+	fDeflater = new deflater (fBuffer);
+}
+
+//______________________________________________________________________________
+void zipwriter::write (const char* data, size_t size)
+{
+	if (!fDeflater) return;
+	zipfile::entry& e = fEntries.back();
+	e.crc = crc32 (e.crc, (const unsigned char*)data, size);
+	e.size += size;
+	fDeflater->write ((const unsigned char*)data, size);
+	e.compressedSize += fBuffer.size();
+	flush();
+}
+
+//______________________________________________________________________________
+void zipwriter::close ()
+{
+	if (!fDeflater) return;
+	zipfile::entry& e = fEntries.back();
+	fDeflater->finish();
+	e.compressedSize += fBuffer.size();
+	delete fDeflater;
+	fDeflater = 0;
+	write32 (fBuffer, kDataDescriptorSig);
+	write32 (fBuffer, e.crc);
+	write32 (fBuffer, e.compressedSize);
+	write32 (fBuffer, e.size);
+	flush();
+}
+
+//______________________________________________________________________________
+void zipwriter::finish ()
+{
+	close();
+	size_t start = fOffset;
+	for (vector<zipfile::entry>::const_iterator i = fEntries.begin(); i != fEntries.end(); i++)
+		header (*i, true);
+	size_t size = fOffset + fBuffer.size() - start;
+	write32 (fBuffer, kEndOfDirSig);
+	write16 (fBuffer, 0);				// disk number
+	write16 (fBuffer, 0);				// disk of the central directory
+	write16 (fBuffer, unsigned(fEntries.size()));
+	write16 (fBuffer, unsigned(fEntries.size()));
+	write32 (fBuffer, size);
+	write32 (fBuffer, start);
+	write16 (fBuffer, 0);				// comment length
+	flush();
+}
+
+}
@@ -0,0 +1,116 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __zipfile__
+#define __zipfile__
+
+#include <string>
+#include <vector>
+
+#include "deflate.h"
+#include "mappedfile.h"
+#include "xmlwriter.h"
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+/*!
+\internal
+\brief a read only zip archive, as used by the compressed MusicXML format (.mxl).
+
+	Entries can be stored or deflated. Zip64 archives are not supported.
+*/
+class zipfile
+{
+	public:
+		typedef struct {
+			std::string		name;
+			int				method;		// 0: stored, 8: deflated
+			unsigned long	crc;
+			size_t			compressedSize;
+			size_t			size;
+			size_t			offset;		// offset of the local header
+		} entry;
+
+				 zipfile (const char* file);
+		virtual ~zipfile () {}
+
+		//! the archive entries, empty when the file is not a valid zip archive
+		const std::vector<entry>& entries () const	{ return fEntries; }
+		//! looks for an entry by name
+		const entry*	find (const std::string& name) const;
+		/*!	\brief extracts an entry
+			\param e the entry to extract
+			\param size on output, the size of the extracted data
+			\return a buffer allocated with malloc, terminated by 2 null chars (not included in size),
+				or 0 in case of error.
+		*/
+		char*			extract (const entry& e, size_t& size) const;
+
+		//! gives the MusicXML root file name, as declared by META-INF/container.xml
+		std::string		rootfile () const;
+
+	private:
+		mappedfile			fData;
+		std::vector<entry>	fEntries;
+
+		bool	readDirectory ();
+};
+
+//______________________________________________________________________________
+/*!
+\internal
+\brief a zip archive writer, as used by the compressed MusicXML format (.mxl).
+
+	The archive is written in a single pass to a sink: the stored entries are given
+	at once, the deflated entries are compressed while written and their crc and
+	sizes follow their data (data descriptor). Zip64 archives are not supported.
+*/
+class zipwriter : public xmlsink
+{
+	public:
+				 zipwriter (xmlsink* out);
+		virtual ~zipwriter ();
+
+		//! adds a stored entry
+		void	add (const std::string& name, const char* data, size_t size);
+		//! starts a deflated entry, its data is given using write
+		void	open (const std::string& name);
+		//! compresses the current entry data
+		void	write (const char* data, size_t size);
+		//! terminates the current entry
+		void	close ();
+		//! writes the central directory, once all the entries are written
+		void	finish ();
+
+	private:
+		xmlsink*					fOut;
+		std::vector<zipfile::entry>	fEntries;
+		size_t						fOffset;		// the archive size
+		unsigned					fTime, fDate;	// the entries modification time, in ms-dos format
+		deflater*					fDeflater;		// the current entry compressor
+		std::string					fBuffer;
+
+		void	header (const zipfile::entry& e, bool central);
+		void	flush ();
+
+				 zipwriter (const zipwriter&);				// not copyable
+		zipwriter&	operator= (const zipwriter&);
+};
+
+//! parses the root file of a compressed MusicXML file (.mxl), decompressed in memory
+bool readmxlfile (const char* file, reader* r);
+
+}
+
+#endif
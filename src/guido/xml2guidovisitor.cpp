@@ -15,10 +15,12 @@
 #endif
 
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 
 #include "partsummary.h"
+#include "parttimeline.h"
 #include "rational.h"
 #include "xml_tree_browser.h"
 #include "xml2guidovisitor.h"
@@ -36,7 +38,6 @@ namespace MusicXML2
     fGenerateBars(generateBar), fGeneratePositions(true),
     fCurrentStaffIndex(0), previousStaffHasLyrics(false), fCurrentAccoladeIndex(0), fPartNum(partNum), defaultStaffDistance(0), defaultGuidoStaffDistance(1)
     {
-        timePositions.clear();
     }
     
     //______________________________________________________________________________
@@ -190,6 +191,39 @@ namespace MusicXML2
     //void xml2guidovisitor::visitStart ( S_score_part& elt )			{ fCurrentPartID = elt->getAttributeValue("id"); }
     //void xml2guidovisitor::visitStart ( S_part_name& elt )			{ fPartHeaders[fCurrentPartID].fPartName = elt; }
     
+    //______________________________________________________________________________
+    // a single traversal of the part for all the voices: the elements are visited by each
+    // voice in turn, except the notes, that are browsed by their voice only and skipped by
+    // the other voices (which only need the notes duration and position).
+    // A measure is browsed by each voice in turn: the default-x positions and the clefs
+    // of the previous voices are thus complete when a voice looks them up.
+    //______________________________________________________________________________
+    static void browseVoices (xmlelement& elt, const vector<xmlpart2guido*>& voices)
+    {
+        if ((elt.getType() == k_measure) && (voices.size() > 1)) {
+            for (size_t i = 0; i < voices.size(); i++)
+                browseVoices (elt, vector<xmlpart2guido*>(1, voices[i]));
+            return;
+        }
+        if (elt.getType() == k_note) {
+            int voice = elt.getIntValue(k_voice, notevisitor::kUndefinedVoice);
+            for (size_t i = 0; i < voices.size(); i++) {
+                if (voices[i]->getTargetVoice() == voice) {
+                    xml_tree_browser browser(voices[i]);
+                    browser.browse(elt);
+                }
+                else voices[i]->skipNote (elt);
+            }
+            return;
+        }
+        for (size_t i = 0; i < voices.size(); i++)
+            elt.acceptIn (*voices[i]);
+        for (ctree<xmlelement>::literator iter = elt.lbegin(); iter != elt.lend(); iter++)
+            browseVoices (**iter, voices);
+        for (size_t i = 0; i < voices.size(); i++)
+            elt.acceptOut (*voices[i]);
+    }
+    
     //______________________________________________________________________________
     void xml2guidovisitor::visitStart ( S_part& elt )
     {
@@ -207,15 +241,22 @@ namespace MusicXML2
         xml_tree_browser browser(&ps);
         browser.browse(*elt);
         
+        // the part time base, shared by the voices
+        Sparttimeline timeline = parttimeline::create(elt);
+        
         smartlist<int>::ptr voices = ps.getVoices ();
         int targetStaff = 0xffff;	// initialized to a value we'll unlikely encounter
         bool notesOnly = false;
-        rational currentTimeSign (0,1);
+        int stafflines = elt->getIntValue(k_staff_lines, 0);
         
-        staffClefMap.clear();
-        //timePositions.clear();
+        // the voices converters, fed by a single traversal of the part (see browseVoices)
+        vector<unique_ptr<xmlpart2guido> > converters;
+        vector<xmlpart2guido*> voiceConverters;
+        vector<Sguidoelement> seqs;
+        vector<int> staves;
+        size_t staffFirstVoice = 0;
         
-        // browse the parts voice by voice: allows to describe voices that spans over several staves
+        // creates the voices: allows to describe voices that spans over several staves
         for (unsigned int i = 0; i < voices->size(); i++) {
             int targetVoice = (*voices)[i];
             int mainstaff = ps.getMainStaff(targetVoice);
@@ -226,8 +267,8 @@ namespace MusicXML2
                 notesOnly = false;
                 targetStaff = mainstaff;
                 fCurrentStaffIndex++;
-                /// Clear timePositions so that we only track voices on a specific Staff
-                timePositions.clear();
+                /// only the voices on a specific Staff share their time positions
+                staffFirstVoice = i;
             }
             
             Sguidoelement seq = guidoseq::create();
@@ -241,42 +282,8 @@ namespace MusicXML2
             std::string autoHideTiedAccidentals = "set<autoHideTiedAccidentals=\"on\">";
             tag = guidotag::create(autoHideTiedAccidentals);
             add(tag);
-                        
-            //// Add staffFormat if needed
-            // Case1: If previous staff has Lyrics, then move current staff lower to create space: \staffFormat<dy=-5>
-            int stafflines = elt->getIntValue(k_staff_lines, 0);
             
-            if ((previousStaffHasLyrics)||stafflines||defaultGuidoStaffDistance||ps.fStaffDistances.size())
-            {
-                Sguidoelement tag2 = guidotag::create("staffFormat");
-                if (previousStaffHasLyrics)
-                {
-                    tag2->add (guidoparam::create("dy=-5", false));
-                }else if (ps.fStaffDistances.size()> size_t(targetStaff-1)) {
-                    
-                    if (ps.fStaffDistances[targetStaff-1] > 0) {
-                        float xmlDistance = ps.fStaffDistances[targetStaff-1] - 50.0;
-                        float HalfSpaceDistance = -1.0 * (xmlDistance / 10) * 2 ; // -1.0 for Guido scale // (pos/10)*2
-                    
-                        stringstream s;
-                        s << "dy="<< HalfSpaceDistance;
-                        tag2->add (guidoparam::create(s.str().c_str(), false));
-                    }
-                }else if (defaultGuidoStaffDistance) {
-                    stringstream s;
-                    s << "dy="<< defaultGuidoStaffDistance;
-                    tag2->add (guidoparam::create(s.str().c_str(), false));
-                }
-                
-                if (stafflines>0)
-                {
-                    stringstream staffstyle;
-                    staffstyle << "style=\"" << stafflines<<"-line\"";
-                    tag2->add (guidoparam::create(staffstyle.str(),false));
-                }
-                add (tag2);
-            }
-            ////
+            // the staffFormat depends on the previous voice lyrics: it is inserted here once the part is converted
             
             flushHeader (fHeader);
             flushPartHeader (fPartHeaders[elt->getAttributeValue("id")]);
@@ -318,19 +325,59 @@ namespace MusicXML2
             
             ////
             
-            //// Browse XML and convert
-            xmlpart2guido pv(fGenerateComments, fGenerateStem, fGenerateBars);
-            pv.generatePositions (fGeneratePositions);
-            xml_tree_browser browser(&pv);
-            pv.initialize(seq, targetStaff, fCurrentStaffIndex, targetVoice, notesOnly, currentTimeSign);
-            pv.staffClefMap = staffClefMap;
-            pv.timePositions = timePositions;
-            browser.browse(*elt);
             pop();
-            currentTimeSign = pv.getTimeSign();
-            previousStaffHasLyrics = pv.hasLyrics();
-            staffClefMap = pv.staffClefMap;
-            timePositions = pv.timePositions;
+            
+            unique_ptr<xmlpart2guido> pv (new xmlpart2guido(fGenerateComments, fGenerateStem, fGenerateBars));
+            pv->generatePositions (fGeneratePositions);
+            pv->setTimeline (timeline);
+            pv->initialize(seq, targetStaff, fCurrentStaffIndex, targetVoice, notesOnly, rational(0,1));
+            for (size_t j = 0; j < converters.size(); j++)
+                pv->follow (*converters[j], j >= staffFirstVoice);
+            voiceConverters.push_back (pv.get());
+            converters.push_back (std::move(pv));
+            seqs.push_back (seq);
+            staves.push_back (targetStaff);
+        }
+        
+        //// Browse XML and convert
+        browseVoices (*elt, voiceConverters);
+        
+        for (size_t i = 0; i < converters.size(); i++) {
+            //// Add staffFormat if needed
+            // Case1: If previous staff has Lyrics, then move current staff lower to create space: \staffFormat<dy=-5>
+            if ((previousStaffHasLyrics)||stafflines||defaultGuidoStaffDistance||ps.fStaffDistances.size())
+            {
+                Sguidoelement tag2 = guidotag::create("staffFormat");
+                if (previousStaffHasLyrics)
+                {
+                    tag2->add (guidoparam::create("dy=-5", false));
+                }else if (ps.fStaffDistances.size()> size_t(staves[i]-1)) {
+                    
+                    if (ps.fStaffDistances[staves[i]-1] > 0) {
+                        float xmlDistance = ps.fStaffDistances[staves[i]-1] - 50.0;
+                        float HalfSpaceDistance = -1.0 * (xmlDistance / 10) * 2 ; // -1.0 for Guido scale // (pos/10)*2
+                    
+                        stringstream s;
+                        s << "dy="<< HalfSpaceDistance;
+                        tag2->add (guidoparam::create(s.str().c_str(), false));
+                    }
+                }else if (defaultGuidoStaffDistance) {
+                    stringstream s;
+                    s << "dy="<< defaultGuidoStaffDistance;
+                    tag2->add (guidoparam::create(s.str().c_str(), false));
+                }
+                
+                if (stafflines>0)
+                {
+                    stringstream staffstyle;
+                    staffstyle << "style=\"" << stafflines<<"-line\"";
+                    tag2->add (guidoparam::create(staffstyle.str(),false));
+                }
+                // after the staff and the autoHideTiedAccidentals tags
+                seqs[i]->elements().insert (seqs[i]->elements().begin() + 2, tag2);
+            }
+            ////
+            previousStaffHasLyrics = converters[i]->hasLyrics();
         }
     }
     
@@ -57,8 +57,10 @@ namespace MusicXML2
         fInCue = fInGrace = fInhibitNextBar = fPendingBar = fDoubleBar
         = fBeamOpened = fCrescPending = fSkipDirection = fWavyTrillOpened = fSingleScopeTrill = fNonStandardNoteHead = false;
         fCurrentStemDirection = kStemUndefined;
-        fCurrentDivision = 1;
+        setDivision (1);
         fCurrentOffset = 0;
+        fCurrentMeasureLength = fCurrentMeasurePosition = fCurrentVoiceTicks = 0;
+        fCueDuration = 0;
         fPendingPops = 0;
         fMeasNum = 0;
         fLyricsManualSpacing = false;
@@ -131,17 +133,16 @@ namespace MusicXML2
             pop();
             fInCue = false;
             
-            // add EMPTY if durationInCue>0 and fCurrentMeasurePosition is not equal to fCurrentMeasureLength
-            durationInCue.rationalise();
-            if (durationInCue.getNumerator() > 0) {
-                guidonoteduration dur (durationInCue.getNumerator(), durationInCue.getDenominator());
+            // add EMPTY if fCueDuration>0 and fCurrentMeasurePosition is not equal to fCurrentMeasureLength
+            if (fCueDuration > 0) {
+                rational r = wholeNotes (fCueDuration);
+                guidonoteduration dur (r.getNumerator(), r.getDenominator());
                 Sguidoelement note = guidonote::create(fTargetVoice, "empty", 0, dur, "");
                 add (note);
-                fCurrentVoicePosition += durationInCue;
-                fCurrentVoicePosition.rationalise();
+                moveVoiceTime (fCueDuration);
             }
             
-            durationInCue = 0;
+            fCueDuration = 0;
         }
         if (fInGrace) {
             pop();
@@ -170,37 +171,120 @@ namespace MusicXML2
     //______________________________________________________________________________
     void xmlpart2guido::moveMeasureTime (int duration, bool moveVoiceToo, int x_default)
     {
-        rational r(duration, fCurrentDivision*4);
-        r.rationalise();
-        fCurrentMeasurePosition += r;
-        fCurrentMeasurePosition.rationalise();
+        long ticks = duration * fTicksPerDivision;
+        fCurrentMeasurePosition += ticks;
         if (fCurrentMeasurePosition > fCurrentMeasureLength)
             fCurrentMeasureLength = fCurrentMeasurePosition;
-        if (moveVoiceToo) {
-            fCurrentVoicePosition += r;
-            fCurrentVoicePosition.rationalise();
+        if (moveVoiceToo) moveVoiceTime (ticks);
+    }
+    
+    //______________________________________________________________________________
+    void xmlpart2guido::moveVoiceTime (long ticks)
+    {
+        fCurrentVoiceTicks += ticks;
+    }
+    
+    //______________________________________________________________________________
+    // the notes default-x, tracked by measure and by position to infer the notes offsets.
+    // the positions of the previous voices of the staff are looked up together with the
+    // voice own positions
+    //______________________________________________________________________________
+    void xmlpart2guido::addTimePosition (int measureNum, int x_default)
+    {
+        if (x_default != -1)
+            timePositions[measureNum][currentVoicePosition()].push_back(x_default);
+    }
+
+    bool xmlpart2guido::hasTimePositions (int measureNum) const
+    {
+        if (timePositions.find(measureNum) != timePositions.end()) return true;
+        for (size_t i = 0; i < fPreviousPositions.size(); i++)
+            if (fPreviousPositions[i]->find(measureNum) != fPreviousPositions[i]->end()) return true;
+        return false;
+    }
+
+    bool xmlpart2guido::minTimePosition (int measureNum, const rational& pos, int& xpos) const
+    {
+        bool found = false;
+        for (size_t i = 0; i <= fPreviousPositions.size(); i++) {
+            const std::map< int, std::map< rational, std::vector<int> > >& positions = (i < fPreviousPositions.size()) ? *fPreviousPositions[i] : timePositions;
+            auto timePos4measure = positions.find(measureNum);
+            if (timePos4measure == positions.end()) continue;
+            auto voiceInTimePosition = timePos4measure->second.find(pos);
+            if (voiceInTimePosition == timePos4measure->second.end()) continue;
+            int minXPos = *std::min_element(voiceInTimePosition->second.begin(), voiceInTimePosition->second.end());
+            if (!found || (minXPos < xpos)) xpos = minXPos;
+            found = true;
+        }
+        return found;
+    }
+
+    //______________________________________________________________________________
+    void xmlpart2guido::follow (const xmlpart2guido& previous, bool sameStaff)
+    {
+        fPreviousClefs.push_back (&previous.staffClefMap);
+        if (sameStaff) fPreviousPositions.push_back (&previous.timePositions);
+    }
+
+    //______________________________________________________________________________
+    // a note of another voice: only the time is moved and the position tracked,
+    // as in visitEnd (S_note) when the note is not in the target voice
+    //______________________________________________________________________________
+    void xmlpart2guido::skipNote (xmlelement& note)
+    {
+        bool grace = false;
+        int duration = 0;
+        for (ctree<xmlelement>::literator i = note.lbegin(); i != note.lend(); i++) {
+            switch ((*i)->getType()) {
+                case k_chord:		return;			// chord notes have already been handled
+                case k_grace:		grace = true; break;
+                case k_duration:	duration = int(**i); break;
+            }
         }
+        isProcessingChord = false;
+        if (grace) return;
+
+        addTimePosition (fCurrentMeasure->getAttributeIntValue("number", 0), note.getAttributeIntValue("default-x", -1));
+        moveMeasureTime (duration, false);
+        checkDelayed (duration);
+    }
+
+    //______________________________________________________________________________
+    // the time is expressed in ticks, using the part timeline. Without timeline
+    // (e.g. when the part is not visited), the current division is used as tick.
+    //______________________________________________________________________________
+    void xmlpart2guido::setDivision (long division)
+    {
+        fCurrentDivision = division;
+        fTicksPerDivision = fTimeline ? fTimeline->ticksPerDivision (division) : 1;
+    }
+    
+    rational xmlpart2guido::wholeNotes (long ticks) const
+    {
+        if (fTimeline) return fTimeline->wholeNotes (ticks);
+        rational r(ticks, fCurrentDivision*4);
+        r.rationalise();
+        return r;
     }
     
     //______________________________________________________________________________
     // check the current position in the current voice:  when it lags behind
     // the current measure position, it creates the corresponding empty element
     //______________________________________________________________________________
-    void xmlpart2guido::checkVoiceTime ( const rational& currTime, const rational& voiceTime)
+    void xmlpart2guido::checkVoiceTime ( long measureTime )
     {
-        rational diff = currTime - voiceTime;
-        diff.rationalise();
-        if (diff.getNumerator() > 0) {
-            guidonoteduration dur (diff.getNumerator(), diff.getDenominator());
+        long diff = measureTime - fCurrentVoiceTicks;
+        if (diff > 0) {
+            rational r = wholeNotes (diff);
+            guidonoteduration dur (r.getNumerator(), r.getDenominator());
             Sguidoelement note = guidonote::create(fTargetVoice, "empty", 0, dur, "");
             add (note);
-            fCurrentVoicePosition += diff;
-            fCurrentVoicePosition.rationalise();
+            moveVoiceTime (diff);
         }
-        else if (diff.getNumerator() < 0)
+        else if (diff < 0)
         {
             if (!fInCue)
-                cerr << "warning! checkVoiceTime: measure time behind voice time " << string(diff) << "(measure "<< fMeasNum<<")" << endl;
+                cerr << "warning! checkVoiceTime: measure time behind voice time " << string(wholeNotes (diff)) << "(measure "<< fMeasNum<<")" << endl;
         }
     }
     
@@ -228,8 +312,7 @@ namespace MusicXML2
         stackClean();	// closes pending chords, cue and grace
         
         if (duration) {
-            rational r(duration, fCurrentDivision*4);
-            r.rationalise();
+            rational r = wholeNotes (duration * fTicksPerDivision);
             guidonoteduration dur (r.getNumerator(), r.getDenominator());
             Sguidoelement note = guidonote::create(fTargetVoice, "empty", 0, dur, "");
             add (note);
@@ -241,6 +324,10 @@ namespace MusicXML2
     void xmlpart2guido::visitStart ( S_part& elt )
     {
         reset();
+        if (!fTimeline || ((xmlelement*)fTimeline->part() != (xmlelement*)elt)) {
+            fTimeline = parttimeline::create (elt);
+            setDivision (fCurrentDivision);
+        }
         if (!current()) {
             Sguidoelement seq = guidoseq::create();
             start (seq);
@@ -273,9 +360,9 @@ namespace MusicXML2
         }
         fCurrentMeasure = elt;
         fMeasNum++;
-        fCurrentMeasureLength.set  (0, 1);
-        fCurrentMeasurePosition.set(0, 1);
-        fCurrentVoicePosition.set  (0, 1);
+        fCurrentMeasureLength = 0;
+        fCurrentMeasurePosition = 0;
+        fCurrentVoiceTicks = 0;
         fInhibitNextBar = false; // fNotesOnly;
         fPendingBar = false;
         fDoubleBar = false;
@@ -294,12 +381,12 @@ namespace MusicXML2
     void xmlpart2guido::visitEnd ( S_measure& elt )
     {
         stackClean();	// closes pending chords, cue and grace
-        checkVoiceTime (fCurrentMeasureLength, fCurrentVoicePosition);
+        checkVoiceTime (fCurrentMeasureLength);
         
         if (!fInhibitNextBar) {
             if (fGenerateBars) fPendingBar = true;
             else if (!fMeasureEmpty) {
-                if (fCurrentVoicePosition < fCurrentMeasureLength)
+                if (fCurrentVoiceTicks < fCurrentMeasureLength)
                     fPendingBar = true;
             }
         }
@@ -758,7 +845,7 @@ namespace MusicXML2
                 
             }else if (type == "crescendo")
             {
-                ctree<xmlelement>::iterator wedgeBegin= find(fCurrentPart->begin(), fCurrentPart->end(), elt);
+                ctree<xmlelement>::iterator wedgeBegin= fCurrentPart->locate(elt);
                 int crescendoNumber = elt->getAttributeIntValue("number", 1);   // default is 1 for wedge!
                 ctree<xmlelement>::iterator nextevent  = wedgeBegin;
                 nextevent++;    // advance one step
@@ -1074,7 +1161,7 @@ std::string xmlpart2guido::parseMetronome ( metronomevisitor &mv )
         // set division
         int divisions = (elt)->getIntValue(k_divisions, -1);
         if (divisions != -1)
-            fCurrentDivision = divisions;
+            setDivision (divisions);
         
         // Generate Clef first
         iter = elt->find(k_clef);
@@ -1120,7 +1207,7 @@ std::string xmlpart2guido::parseMetronome ( metronomevisitor &mv )
             tag->add (guidoparam::create(param));
             add(tag);
             
-            std::pair<rational, std::string> foo = std::pair<rational, std::string>(fCurrentVoicePosition ,param);
+            std::pair<rational, std::string> foo = std::pair<rational, std::string>(currentVoicePosition() ,param);
             staffClefMap.insert(std::pair<int, std::pair < int , std::pair<rational, std::string> > >(fCurrentStaffIndex, std::pair< int, std::pair< rational, std::string > >(fMeasNum, foo) ) );
             
             /// Search again for other clefs:
@@ -1348,7 +1435,7 @@ bool xmlpart2guido::isSlurClosing(S_slur elt) {
     int internalXMLSlurNumber = elt->getAttributeIntValue("number", 0);
 
     //cerr<< "\tSearching Slur Closing for line:"<<elt->getInputLineNumber() <<" with number "<<internalXMLSlurNumber<< " on Measure:"<<fMeasNum<< " on voice:"<<fTargetVoice<<endl;
-    ctree<xmlelement>::iterator nextnote = find(fCurrentPart->begin(), fCurrentPart->end(), elt);
+    ctree<xmlelement>::iterator nextnote = fCurrentPart->locate(elt);
     if (nextnote != fCurrentPart->end()) {
         nextnote++;    // advance one step
     }
@@ -1575,7 +1662,7 @@ std::vector< std::pair<int, int> >::const_iterator xmlpart2guido::findSlur ( con
                 topNoteDurRational *= tm;topNoteDurRational.rationalise();
 
                 /// Browse through all elements of Tuplet until "stop"!
-                ctree<xmlelement>::iterator nextnote = find(fCurrentMeasure->begin(), fCurrentMeasure->end(), elt);
+                ctree<xmlelement>::iterator nextnote = fCurrentMeasure->locate(elt);
                 if (nextnote != fCurrentMeasure->end()) {
                     nextnote++;	// advance one step
                 }
@@ -2081,7 +2168,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
                     tag = guidotag::create("trem");
                     
                     /// Find "stop" pitch
-                    ctree<xmlelement>::iterator nextnote = find(fCurrentMeasure->begin(), fCurrentMeasure->end(), elt);
+                    ctree<xmlelement>::iterator nextnote = fCurrentMeasure->locate(elt);
                     if (nextnote != fCurrentMeasure->end()) nextnote++;    // advance one step
                     while (nextnote != fCurrentMeasure->end()) {
                         // looking for the next note on the target voice
@@ -2146,7 +2233,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
     vector<Sxmlelement> xmlpart2guido::getChord ( const S_note& elt )
     {
         vector<Sxmlelement> v;
-        ctree<xmlelement>::iterator nextnote = find(fCurrentMeasure->begin(), fCurrentMeasure->end(), elt);
+        ctree<xmlelement>::iterator nextnote = fCurrentMeasure->locate(elt);
         if (nextnote != fCurrentMeasure->end()) nextnote++;	// advance one step
         while (nextnote != fCurrentMeasure->end()) {
             // looking for the next note on the target voice
@@ -2165,7 +2252,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
     vector<Sxmlelement> xmlpart2guido::getChord ( const Sxmlelement& elt )
     {
         vector<Sxmlelement> v;
-        ctree<xmlelement>::iterator nextnote = find(fCurrentMeasure->begin(), fCurrentMeasure->end(), elt);
+        ctree<xmlelement>::iterator nextnote = fCurrentMeasure->locate(elt);
         if (nextnote != fCurrentMeasure->end()) nextnote++;    // advance one step
         while (nextnote != fCurrentMeasure->end()) {
             // looking for the next note on the target voice
@@ -2193,26 +2280,21 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
             
             // add up duration in Cue
             if (!nv.inChord())
-            {
-                rational r(nv.getDuration(), fCurrentDivision*4);
-                r.rationalise();
-                durationInCue += r;
-            }
+                fCueDuration += nv.getDuration() * fTicksPerDivision;
         }
         else if (fInCue) {
             fInCue = false;
             pop();
             
-            durationInCue.rationalise();
-            if (durationInCue.getNumerator() > 0) {
-                guidonoteduration dur (durationInCue.getNumerator(), durationInCue.getDenominator());
+            if (fCueDuration > 0) {
+                rational r = wholeNotes (fCueDuration);
+                guidonoteduration dur (r.getNumerator(), r.getDenominator());
                 Sguidoelement note = guidonote::create(fTargetVoice, "empty", 0, dur, "");
                 add (note);
-                fCurrentVoicePosition += durationInCue;
-                fCurrentVoicePosition.rationalise();
+                moveVoiceTime (fCueDuration);
             }
             
-            durationInCue = 0;
+            fCueDuration = 0;
         }
     }
     
@@ -2222,7 +2304,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
         if (nv.isGrace()) {
             if (!fInGrace) {
                 /// GUID-153: Fetch directions after grace
-                ctree<xmlelement>::iterator nextnote = find(fCurrentMeasure->begin(), fCurrentMeasure->end(), nv.getSnote());
+                ctree<xmlelement>::iterator nextnote = fCurrentMeasure->locate(nv.getSnote());
                 nextnote.forward_up(); // forward one element
                 while (nextnote != fCurrentMeasure->end()) {
                     // break if next element is a non-grace
@@ -2266,7 +2348,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
         // End grace BEFORE the next non-grace note to avoid conflict with S_direction
         if (fInGrace)
         {
-            ctree<xmlelement>::iterator nextnote = find(fCurrentMeasure->begin(), fCurrentMeasure->end(), nv.getSnote());
+            ctree<xmlelement>::iterator nextnote = fCurrentMeasure->locate(nv.getSnote());
             nextnote++;	// advance one step
             while (nextnote != fCurrentMeasure->end()) {
                 if ((nextnote->getType() == k_note) && (nextnote->getIntValue(k_voice,0) == fTargetVoice)){
@@ -2439,9 +2521,9 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
         /// Add Note head of X offset for note if necessary
         bool noteFormat = false;
         int measureNum = fCurrentMeasure->getAttributeIntValue("number", 0);
-        auto timePos4measure = timePositions.find(measureNum);
+        bool timePos4measure = hasTimePositions(measureNum);
         if ( (nv.fNotehead
-              || ((timePos4measure != timePositions.end()) ) )             // if we need to infer default-x
+              || timePos4measure )             // if we need to infer default-x
             &&  fInGrace==false  )      // FIXME: Workaround for GUID-74
         {
             Sguidoelement noteFormatTag = guidotag::create("noteFormat");
@@ -2459,18 +2541,15 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
             }
             
             /// check for dx inference from default_x but avoid doing this for Chords as Guido handles this automatically!
-            if (timePos4measure != timePositions.end() && (isProcessingChord==false)) {
-                auto voiceInTimePosition = timePos4measure->second.find(posInMeasure);
-                if (voiceInTimePosition != timePos4measure->second.end()) {
-                    auto minXPos = std::min_element(voiceInTimePosition->second.begin(),voiceInTimePosition->second.end() );
-                    if (nv.x_default != *minXPos) {
-                        int noteDx = ( (nv.x_default - *minXPos)/ 10 ) * 2;   // convert to half spaces
-                        
-                        stringstream s;
-                        s << "dx=" << noteDx ;
-                        noteFormatTag->add (guidoparam::create(s.str(), false));
-                        noteFormat = true;
-                    }
+            int minXPos;
+            if (timePos4measure && (isProcessingChord==false) && minTimePosition(measureNum, posInMeasure, minXPos)) {
+                if (nv.x_default != minXPos) {
+                    int noteDx = ( (nv.x_default - minXPos)/ 10 ) * 2;   // convert to half spaces
+                    
+                    stringstream s;
+                    s << "dx=" << noteDx ;
+                    noteFormatTag->add (guidoparam::create(s.str(), false));
+                    noteFormat = true;
                 }
             }
             
@@ -2502,19 +2581,17 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
     int xmlpart2guido::checkNoteFormatDx	 ( const notevisitor& nv , rational posInMeasure)
     {
         int measureNum = fCurrentMeasure->getAttributeIntValue("number", 0);
-        auto timePos4measure = timePositions.find(measureNum);
         
-        if ( timePos4measure != timePositions.end())
+        if (hasTimePositions(measureNum))
         {
             Sguidoelement noteFormatTag = guidotag::create("noteFormat");
             
             /// check for dx inference from default_x but avoid doing this for Chords as Guido handles this automatically!
-            if (timePos4measure != timePositions.end() && (isProcessingChord==false)) {
-                auto voiceInTimePosition = timePos4measure->second.find(posInMeasure);
-                if (voiceInTimePosition != timePos4measure->second.end()) {
-                    auto minXPos = std::min_element(voiceInTimePosition->second.begin(),voiceInTimePosition->second.end() );
-                    if (nv.x_default != *minXPos) {
-                        int noteDx = ( (nv.x_default - *minXPos)/ 10 ) * 2;   // convert to half spaces
+            if (isProcessingChord==false) {
+                int minXPos;
+                if (minTimePosition(measureNum, posInMeasure, minXPos)) {
+                    if (nv.x_default != minXPos) {
+                        int noteDx = ( (nv.x_default - minXPos)/ 10 ) * 2;   // convert to half spaces
                         
                         stringstream s;
                         s << "dx=" << noteDx ;
@@ -2535,7 +2612,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
         if (nv.getStep().size())
         {
             // Check out clef for position and voice
-            std::string thisClef = getClef(fCurrentStaffIndex , fCurrentVoicePosition, fMeasNum);
+            std::string thisClef = getClef(fCurrentStaffIndex , currentVoicePosition(), fMeasNum);
             float noteHeadPos=nv.getNoteHeadDy(thisClef);
             float restformatDy = noteHeadPos;
             // Rest default position in Guido (dy 0) is the middle line of the staff
@@ -2569,8 +2646,10 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
     std::string xmlpart2guido::getClef(int staffIndex, rational pos, int measureNum) {
         //     std::multimap<int,  std::pair< int, std::pair< rational, string > > > staffClefMap;
         std::string thisClef = "g";
-        if (staffClefMap.size()>0) {
-            auto staffRange = staffClefMap.equal_range(staffIndex);
+        // the clefs of the previous voices come first, as if they were inserted in this voice map
+        for (size_t n = 0; n <= fPreviousClefs.size(); n++) {
+            const std::multimap<int,  std::pair< int, std::pair< rational, string > > >& clefs = (n < fPreviousClefs.size()) ? *fPreviousClefs[n] : staffClefMap;
+            auto staffRange = clefs.equal_range(staffIndex);
             
             for (auto i = staffRange.first ; i != staffRange.second; i++ )
             {
@@ -2578,7 +2657,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
                 if (((i->second).first <= measureNum) && ((i->second).second.first <= pos )){
                     thisClef = (i->second).second.second;
                 }else
-                    break;
+                    return thisClef;
             }
         }
         return thisClef;
@@ -2593,7 +2672,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
         
         isProcessingChord = false;
         
-        rational thisNoteHeadPosition = fCurrentVoicePosition;
+        rational thisNoteHeadPosition = currentVoicePosition();
         
         int pendingPops = 0;
         
@@ -2601,30 +2680,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
         if (!isGrace() ) {
             //////// Track all voice default-x parameters, as positions in measures
             
-            if (true) {     // had fNotesOnly
-                int measureNum = fCurrentMeasure->getAttributeIntValue("number", 0);
-                auto timePos4measure = timePositions.find(measureNum);
-                if (notevisitor::x_default != -1) {
-                    if ( timePos4measure !=  timePositions.end())
-                    {
-                        
-                        if (timePos4measure->second.find(fCurrentVoicePosition) != timePos4measure->second.end())
-                        {
-                            // Exists.. push it to vector
-                            timePos4measure->second.find(fCurrentVoicePosition)->second.push_back(notevisitor::x_default);
-                        }else {
-                            // Doesn't exist.. insert with this element's x_default
-                            timePos4measure->second.insert(std::pair<rational, std::vector<int> >
-                                                           (fCurrentVoicePosition, std::vector<int>(1, notevisitor::x_default)) );
-                        }
-                    }else {
-                        std::map<rational, std::vector<int> > inner;
-                        inner.insert(std::make_pair(fCurrentVoicePosition, std::vector<int>(1, notevisitor::x_default)));
-                        timePositions.insert(std::make_pair(measureNum, inner));
-                    }
-                }
-            }
-            
+            addTimePosition (fCurrentMeasure->getAttributeIntValue("number", 0), notevisitor::x_default);
             moveMeasureTime (getDuration(), scanVoice);
             checkDelayed (getDuration());		// check for delayed elements (directions with offset)
         }
@@ -2641,7 +2697,7 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
         
         checkStaff(notevisitor::getStaff());
         
-        checkVoiceTime (fCurrentMeasurePosition, fCurrentVoicePosition);
+        checkVoiceTime (fCurrentMeasurePosition);
         
         checkCue(*this);
         if (notevisitor::getType() != notevisitor::kRest)
@@ -2732,24 +2788,21 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
     //______________________________________________________________________________
     void xmlpart2guido::visitStart ( S_divisions& elt )
     {
-        fCurrentDivision = (long)(*elt);
+        setDivision ((long)(*elt));
     }
     
     // MARK: Tag Add Methods using element parsing
     float xmlpart2guido::xPosFromTimePos(float default_x, float relative_x) {
-        auto timePos4measure = timePositions.find(fMeasNum);
-        
         float xpos = default_x + relative_x;
         
-        if ((xpos!=0)&&(timePos4measure != timePositions.end())) {
-            auto voiceInTimePosition = timePos4measure->second.find(fCurrentVoicePosition);
-            if (voiceInTimePosition != timePos4measure->second.end()) {
-                auto minXPos = std::min_element(voiceInTimePosition->second.begin(),voiceInTimePosition->second.end() );
-                if (xpos != *minXPos) {
+        if (xpos!=0) {
+            int minXPos;
+            if (minTimePosition(fMeasNum, currentVoicePosition(), minXPos)) {
+                if (xpos != minXPos) {
                     int finalDx = (relative_x/10)*2;
                     // apply default-x ONLY if it exists
                     if (default_x!=0)
-                        finalDx = ( (xpos - *minXPos)/ 10 ) * 2;   // convert to half spaces
+                        finalDx = ( (xpos - minXPos)/ 10 ) * 2;   // convert to half spaces
                     
                     /// FIXME: Can't handle OFFSET with Guido! If positive, just add a small value for coherence!
                     if (fCurrentOffset>0)
@@ -2758,14 +2811,14 @@ void xmlpart2guido::checkPostArticulation ( const notevisitor& note )
                     return finalDx;
                 }
             }//else {
-            //    cerr<<"ERROR: NO TIME POS FOR VOICE POSITION"<<fCurrentVoicePosition.toString()<<" TO INFER Dx for DYNAMICS!"<<endl;
+            //    cerr<<"ERROR: NO TIME POS FOR VOICE POSITION"<<currentVoicePosition().toString()<<" TO INFER Dx for DYNAMICS!"<<endl;
             //}
         }
         return -999;        // This is when the xpos can not be computed
     }
 
 bool xmlpart2guido::findNextNote(const S_note& elt, ctree<xmlelement>::iterator &nextnote) {
-    ctree<xmlelement>::iterator nextnotetmp = find(fCurrentMeasure->begin(), fCurrentMeasure->end(), elt);
+    ctree<xmlelement>::iterator nextnotetmp = fCurrentMeasure->locate(elt);
     if (nextnotetmp != fCurrentMeasure->end()) nextnotetmp++;    // advance one step
     while (nextnotetmp != fCurrentMeasure->end()) {
         // looking for the next note on the target voice
@@ -2779,7 +2832,7 @@ bool xmlpart2guido::findNextNote(const S_note& elt, ctree<xmlelement>::iterator
 }
 
 void xmlpart2guido::addPosYforNoteHead(const notevisitor& nv, Sxmlelement elt, Sguidoelement& tag, float offset) {
-    std::string thisClef = getClef(fCurrentStaffIndex , fCurrentVoicePosition, fMeasNum);
+    std::string thisClef = getClef(fCurrentStaffIndex , currentVoicePosition(), fMeasNum);
     float noteHeadDy = nv.getNoteHeadDy(thisClef);
     float xmlY = xml2guidovisitor::getYposition(elt, 0, true);
     /// Notehead placement from top of the staff is (noteheaddy - 10) for G-Clef, and for F-Clef: (2.0 - noteheaddy)
@@ -2803,7 +2856,7 @@ void xmlpart2guido::addPosYforNoteHead(const notevisitor& nv, Sxmlelement elt, S
 }
 
 float xmlpart2guido::getNoteDistanceFromStaffTop(const notevisitor& nv) {
-    std::string thisClef = getClef(fCurrentStaffIndex , fCurrentVoicePosition, fMeasNum);
+    std::string thisClef = getClef(fCurrentStaffIndex , currentVoicePosition(), fMeasNum);
     float noteHeadDy = nv.getNoteHeadDy(thisClef);
     /// Notehead placement from top of the staff is (noteheaddy - 10) for G-Clef, and for F-Clef: (2.0 - noteheaddy)
     float noteDistanceFromStaffTop = 0.0;
@@ -25,6 +25,7 @@
 #include "keysignvisitor.h"
 #include "metronomevisitor.h"
 #include "notevisitor.h"
+#include "parttimeline.h"
 #include "rational.h"
 #include "timesignvisitor.h"
 #include "typedefs.h"
@@ -101,11 +102,13 @@ class EXP xmlpart2guido :
 	int		fTargetStaff;			// the musicxml target staff (0 by default)
 	int		fTargetVoice;			// the musicxml target voice (0 by default)
 
+	Sparttimeline fTimeline;		// the part time base: the positions below are expressed in ticks
 	long	fCurrentDivision;		// the current measure division, expresses the time unit in division of the quarter note
+	long	fTicksPerDivision;		// the current division expressed in ticks
 	long	fCurrentOffset;			// the current direction offset: represents an element relative displacement in current division unit
-	rational fCurrentMeasureLength;	// the current measure length (max of the current measure positions)
-	rational fCurrentMeasurePosition;// the current position in the measure
-	rational fCurrentVoicePosition;	// the current position within a voice
+	long	fCurrentMeasureLength;	// the current measure length (max of the current measure positions)
+	long	fCurrentMeasurePosition;// the current position in the measure
+	long	fCurrentVoiceTicks;		// the current position within a voice
 	rational fCurrentTimeSign;		// the current time signature
 	int		fMeasNum;
 
@@ -121,6 +124,13 @@ class EXP xmlpart2guido :
 	void pop ()							{ fStack.pop(); }
 
 	void moveMeasureTime (int duration, bool moveVoiceToo=false, int x_default = 0);
+	void addTimePosition (int measureNum, int x_default);	// tracks a note default-x at the current voice position
+	bool hasTimePositions (int measureNum) const;
+	bool minTimePosition (int measureNum, const rational& pos, int& xpos) const;	// the min default-x at pos, false when none
+	void moveVoiceTime (long ticks);
+	void setDivision (long division);
+	rational wholeNotes (long ticks) const;
+	rational currentVoicePosition () const	{ return wholeNotes (fCurrentVoiceTicks); }	// the current voice position in whole notes
 	void reset ();
 	void stackClean	();
 
@@ -149,7 +159,7 @@ class EXP xmlpart2guido :
     bool isSlurClosing(S_slur elt);
 	void checkTiedBegin	 ( const std::vector<S_tied>& tied );
 	void checkTiedEnd	 ( const std::vector<S_tied>& tied );
-	void checkVoiceTime	 ( const rational& currTime, const rational& voiceTime);
+	void checkVoiceTime	 ( long measureTime );
     int  checkRestFormat	 ( const notevisitor& nv );
     int checkNoteFormatDx	 ( const notevisitor& nv , rational posInMeasure);
     void checkWavyTrillBegin	 ( const notevisitor& nv );
@@ -210,7 +220,7 @@ class EXP xmlpart2guido :
     bool findNextNote(const S_note& elt, ctree<xmlelement>::iterator &nextnote);
     float getNoteDistanceFromStaffTop(const notevisitor& nv);
     
-    rational durationInCue;
+    long fCueDuration;		// the duration of the current cue notes, in ticks
     
     std::map<int, float> fStaffDistance;
         
@@ -227,14 +237,34 @@ class EXP xmlpart2guido :
 		void	initialize (Sguidoelement seq, int staff, int guidostaff, int voice, bool notesonly, rational defaultTimeSign);
 		void	generatePositions (bool state)		{ fGeneratePositions = state; }
 		const rational& getTimeSign () const		{ return fCurrentTimeSign; }
+		//! sets the part time base, computed when visiting the part if not set or if it describes another part
+		void	setTimeline (const Sparttimeline& timeline)	{ fTimeline = timeline; }
         bool fHasLyrics;
         bool hasLyrics() const {return fHasLyrics;}
+		int		getTargetVoice () const				{ return fTargetVoice; }
+
+		/*! \brief makes the state of a voice converted before this one visible to this voice
+			The clefs of the previous voices are used to place the notes and the rests, the default-x positions
+			of the previous voices of the same staff are used to infer the notes offsets.
+			The previous voice may be converted in the same part traversal (see skipNote), it must then
+			have completed the current measure since the positions and the clefs are looked up by measure.
+		*/
+		void	follow (const xmlpart2guido& previous, bool sameStaff);
+		/*! \brief processes a note that is not in the target voice, without browsing the note
+			It has the effect of a visit of the note on the time and on the positions,
+			it allows to convert several voices in a single traversal of the part.
+		*/
+		void	skipNote (xmlelement& note);
+
     std::multimap<int,  std::pair< int, std::pair< rational, string > > > staffClefMap;
 
     std::string getClef(int staffIndex, rational pos, int measureNum);
 
     /// Containing default-x positions on a fCurrentVoicePosition (rational) of measure(int)
     std::map< int, std::map< rational, std::vector<int> > > timePositions;
+
+    std::vector<const std::multimap<int,  std::pair< int, std::pair< rational, string > > >*> fPreviousClefs;	// the clefs of the previous voices
+    std::vector<const std::map< int, std::map< rational, std::vector<int> > >*> fPreviousPositions;		// the positions of the previous voices of the staff
     
     void addPosYforNoteHead(const notevisitor& nv, Sxmlelement elt, Sguidoelement& tag, float offset);
     
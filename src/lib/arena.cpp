@@ -0,0 +1,110 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <new>
+#include <stdlib.h>
+
+#include "arena.h"
+
+using namespace std;
+
+namespace MusicXML2 
+{
+
+//______________________________________________________________________________
+// the objects memory is preceded by a header giving the owner arena (null
+// for heap objects, see arena::owner). The header size preserves the objects alignment.
+enum { kHeaderSize = sizeof(arena*), kAlign = sizeof(void*), kBlockSize = 64 * 1024 };
+
+static thread_local arena* gCurrent = 0;
+
+//______________________________________________________________________________
+// the arena holds its own reference in fLive: it is deleted when fLive comes to 0
+arena::arena() : fNext(0), fLeft(0), fLive(1) {}
+arena::~arena()		{ free(); }
+
+void arena::free ()
+{
+	for (vector<char*>::iterator i = fBlocks.begin(); i != fBlocks.end(); i++)
+		::free (*i);
+	fBlocks.clear();
+	fNext = 0;
+	fLeft = 0;
+}
+
+//______________________________________________________________________________
+void* arena::allocate (size_t size)
+{
+	size = (size + kAlign - 1) & ~size_t(kAlign - 1);
+	if (size > fLeft) {
+		size_t blocksize = (size > kBlockSize) ? size : size_t(kBlockSize);
+		char* block = (char*)malloc (blocksize);
+		if (!block) throw bad_alloc();
+		fBlocks.push_back (block);
+		fNext = block;
+		fLeft = blocksize;
+	}
+	void* ptr = fNext;
+	fNext += size;
+	fLeft -= size;
+	return ptr;
+}
+
+//______________________________________________________________________________
+void arena::adopt (smartable* obj)
+{
+	obj->addReference();
+	fObjects.push_back (obj);
+}
+
+//______________________________________________________________________________
+// the objects are released in their creation order: a parent is usually
+// created before its children, deleting it then releases the children references
+// only and the children are deleted in turn by the sweep, without any recursion.
+void arena::release ()
+{
+	for (vector<smartable*>::iterator i = fObjects.begin(); i != fObjects.end(); i++)
+		(*i)->removeReference();
+	fObjects.clear();
+	if (--fLive == 0) delete this;
+}
+
+//______________________________________________________________________________
+arena::scope::scope (arena* a) : fPrevious(gCurrent)	{ gCurrent = a; }
+arena::scope::~scope ()									{ gCurrent = fPrevious; }
+arena* arena::current ()								{ return gCurrent; }
+
+//______________________________________________________________________________
+void* arena::newObject (size_t size)
+{
+	arena* a = gCurrent;
+	char* mem;
+	if (a) {
+		mem = (char*)a->allocate (size + kHeaderSize);
+		a->fLive++;
+	}
+	else mem = (char*)::operator new (size + kHeaderSize);
+	void* ptr = mem + kHeaderSize;
+	owner(ptr) = a;
+	return ptr;
+}
+
+//______________________________________________________________________________
+void arena::deleteObject (void* ptr)
+{
+	if (!ptr) return;
+	arena* a = owner(ptr);
+	if (!a) ::operator delete ((char*)ptr - kHeaderSize);
+	else if (--a->fLive == 0) delete a;
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __arena__
+#define __arena__
+
+#include <cstddef>
+#include <vector>
+#include "exports.h"
+#include "smartpointer.h"
+
+namespace MusicXML2 
+{
+
+/*!
+\brief a bump allocator for smartable objects.
+
+	When an arena is current for a thread (see arena::scope), the objects
+	using arena::newObject as allocator are allocated from the arena, otherwise
+	they are allocated from the heap. An object allocated from an arena is kept
+	alive by the arena until it is released: the objects are then released in
+	their creation order, without any individual memory deallocation.
+	Objects still referenced when the arena is released remain valid: the
+	arena memory is freed when the last of them is deleted.
+*/
+class EXP arena
+{
+	std::vector<char*>		fBlocks;
+	char*					fNext;			// the next free byte in the current block
+	size_t					fLeft;			// the free size in the current block
+	std::vector<smartable*>	fObjects;		// the objects kept alive by the arena
+	std::atomic<size_t>		fLive;			// the count of allocated objects not yet deleted, plus one until released
+
+	void*	allocate (size_t size);
+	void	adopt (smartable* obj);
+	void	free ();
+
+	protected:
+		virtual ~arena();
+
+	public:
+				 arena();
+
+		/*!	\brief releases the objects allocated from the arena
+			The arena is deleted when all the objects have been deleted
+		*/
+		void	release ();
+
+		//! makes an arena current for the calling thread during the scope lifetime
+		class EXP scope {
+			arena* fPrevious;
+			public:
+				 scope (arena* a);
+				~scope ();
+		};
+		//! gives the current arena of the calling thread (may be null)
+		static arena*	current ();
+
+		//! allocates an object memory, from the current arena if any, otherwise from the heap
+		static void*	newObject (size_t size);
+		//! deallocates an object memory allocated with newObject
+		static void		deleteObject (void* ptr);
+		/*!	\brief to be called with newly created objects
+			\param obj the new object, must be the most derived object
+		*/
+		template <typename T> static void created (T* obj)	{ arena* a = owner(obj); if (a) a->adopt (obj); }
+
+	private:
+		static arena*&	owner (void* ptr)	{ return *(arena**)((char*)ptr - sizeof(arena*)); }
+};
+
+}
+
+#endif
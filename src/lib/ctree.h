@@ -13,6 +13,7 @@
 #ifndef __ctree__
 #define __ctree__
 
+#include <algorithm>
 #include <iostream>
 #include <stack>
 #include <vector>
@@ -46,14 +47,44 @@ template <typename T> class EXP treeIterator : public std::iterator<std::input_i
 					 if (end) fCurrentIterator = t->elements().end();
 					 else forward_down (t);
 				 }
+				 //! an iterator positioned on \c child, a direct sub-element of \c t
+				 treeIterator(const T& t, nodes_iterator child) : fRootElement(t), fCurrentIterator(child) {
+					 if (child != t->elements().end())
+						 fStack.push( make_pair(child+1, t));
+				 }
+				 //! an iterator positioned on \c elt, a sub-element of \c t at any depth (end iterator when \c elt is not part of \c t)
+				 treeIterator(const T& t, const T& elt) : fRootElement(t), fCurrentIterator(t->elements().end()) {
+					 std::vector<T> path;		// the elt ancestors up to t
+					 T e = elt;
+					 while (e && (e != t)) {
+						 path.push_back(e);
+						 e = e->parent();
+					 }
+					 if (!e || path.empty()) return;
+					 T parent = t;
+					 for (size_t n = path.size(); n--; ) {
+						 nodes_iterator i = parent->lfind(path[n]);
+						 if (i == parent->elements().end()) {	// inconsistent parent link
+							 fStack = std::stack<state>();
+							 fCurrentIterator = t->elements().end();
+							 return;
+						 }
+						 fStack.push( make_pair(i+1, parent));
+						 fCurrentIterator = i;
+						 parent = path[n];
+					 }
+				 }
 				 treeIterator(const treeIterator& a)  { *this = a; }
 		virtual ~treeIterator() {}
 		
-		T operator  *() const	{ return *fCurrentIterator; }
-		T operator ->() const	{ return *fCurrentIterator; } 
+		// the current element is returned by reference: no reference count change
+		const T& operator  *() const	{ return *fCurrentIterator; }
+		const T& operator ->() const	{ return *fCurrentIterator; } 
 		
 		//________________________________________________________________________
 		T getParent() const		{ return fStack.size() ? fStack.top().second : fRootElement; }
+		//! the element the iterator has been created from
+		const T& getRoot() const		{ return fRootElement; }
 		
 		//________________________________________________________________________
 		// current element has sub-elements: go down to sub-elements first			
@@ -67,14 +98,13 @@ template <typename T> class EXP treeIterator : public std::iterator<std::input_i
 		// current element is empty: go up to parent element and possibly down to neighbor element
 		void forward_up() {
 			while (fStack.size()) {
-				state s = fStack.top();
-				fStack.pop();
-
+				state& s = fStack.top();
 				fCurrentIterator = s.first;
 				if (fCurrentIterator != s.second->elements().end()) {
-					fStack.push( make_pair(fCurrentIterator+1, s.second));
+					s.first = fCurrentIterator+1;		// updated in place
 					return;
 				}
+				fStack.pop();
 			}
 		}
 		
@@ -90,7 +120,9 @@ template <typename T> class EXP treeIterator : public std::iterator<std::input_i
 		//________________________________________________________________________
 		treeIterator& erase() {
 			T parent = getParent();
+			if ((*fCurrentIterator)->fParent == parent) (*fCurrentIterator)->fParent = 0;
 			fCurrentIterator = parent->elements().erase(fCurrentIterator);
+			parent->modified();
 			if (fStack.size()) fStack.pop();
 			if (fCurrentIterator != parent->elements().end()) {
 				fStack.push( make_pair(fCurrentIterator+1, parent));
@@ -103,6 +135,8 @@ template <typename T> class EXP treeIterator : public std::iterator<std::input_i
 		treeIterator& insert(const T& value) {
 			T parent = getParent();
 			fCurrentIterator = parent->elements().insert(fCurrentIterator, value);
+			value->fParent = parent;
+			parent->modified();
 			if (fStack.size()) fStack.pop();
 			fStack.push( make_pair(fCurrentIterator+1, parent));
 			return *this;
@@ -116,8 +150,97 @@ template <typename T> class EXP treeIterator : public std::iterator<std::input_i
 		bool operator !=(const treeIterator& i) const		{ return !(*this == i); }
 };
 
+/*!
+\brief a lightweight top -> bottom tree iterator
+
+	The iterator browses the subtree of a node in document order, the node itself excluded.
+	It maintains a stack of raw pointers in the sub elements vectors, stored inline up to
+	kInlineDepth levels: browsing doesn't allocate memory nor change the reference counts.
+	Contrary to treeIterator, the iterator is invalidated by any modification of the tree.
+*/
+//______________________________________________________________________________
+template <typename T> class EXP treeWalker : public std::iterator<std::forward_iterator_tag, T*>
+{
+	public:
+		enum { kInlineDepth = 16 };
+
+	private:
+		typedef SMARTP<T> treePtr;
+		typedef struct { const treePtr* next; const treePtr* end; } level;
+
+		T*					fCurrent;
+		int					fDepth;
+		level				fLevels[kInlineDepth];
+		std::vector<level>	fDeepLevels;		// the levels beyond kInlineDepth
+
+		level& top ()		{ return (fDepth <= kInlineDepth) ? fLevels[fDepth-1] : fDeepLevels[fDepth-1-kInlineDepth]; }
+		void push (const std::vector<treePtr>& elts) {
+			if (++fDepth > kInlineDepth) fDeepLevels.resize (fDepth - kInlineDepth);
+			level& l = top();
+			l.next = elts.data();
+			l.end = l.next + elts.size();
+		}
+		// goes to the next sibling of the current element or of its ancestors
+		void up () {
+			while (fDepth) {
+				level& l = top();
+				if (l.next != l.end) {
+					fCurrent = *l.next++;
+					return;
+				}
+				fDepth--;
+			}
+			fCurrent = 0;
+		}
+
+	public:
+				 treeWalker() : fCurrent(0), fDepth(0) {}
+				 treeWalker(T* root) : fCurrent(0), fDepth(0) {
+					 if (root && root->elements().size()) {
+						 push (root->elements());
+						 up();
+					 }
+				 }
+		virtual ~treeWalker() {}
+
+		T* operator  *() const	{ return fCurrent; }
+		T* operator ->() const	{ return fCurrent; }
+		//! the current element depth, 1 for the root sub elements
+		int depth () const		{ return fDepth; }
+
+		//! moves forward
+		void forward () {
+			if (fCurrent->elements().size()) push (fCurrent->elements());
+			up();
+		}
+		//! moves forward, skipping the current element sub elements
+		void skip ()			{ up(); }
+
+		treeWalker& operator ++()		{ forward(); return *this; }
+		treeWalker  operator ++(int)	{ treeWalker tmp (*this); forward(); return tmp; }
+
+		bool operator ==(const treeWalker& i) const		{ return fCurrent == i.fCurrent; }
+		bool operator !=(const treeWalker& i) const		{ return fCurrent != i.fCurrent; }
+};
+
+//______________________________________________________________________________
+//! a range of treeWalker, to be used with range-based for loops
+template <typename T> class EXP treeRange
+{
+	T* fRoot;
+	public:
+				 treeRange(T* root) : fRoot(root) {}
+		treeWalker<T> begin () const	{ return treeWalker<T>(fRoot); }
+		treeWalker<T> end () const		{ return treeWalker<T>(); }
+};
+
 /*!
 \brief a simple tree representation
+
+	Each node keeps a link to its parent, set when the node is added to the tree.
+	The parent link is not a reference: it is cleared when the node is removed
+	from the tree or when the parent is deleted. A node shared by several trees
+	(see share) keeps the link to its original parent.
 */
 //______________________________________________________________________________
 template <typename T> class EXP ctree : virtual public smartable
@@ -127,29 +250,62 @@ template <typename T> class EXP ctree : virtual public smartable
 		typedef std::vector<treePtr>		branchs;	///< the node sub elements container type
 		typedef typename branchs::iterator	literator;	///< the current level iterator type
 		typedef treeIterator<treePtr>		iterator;	///< the top -> bottom iterator type
+		typedef treeWalker<T>				walker;		///< the lightweight top -> bottom iterator type
 
 		static treePtr new_tree() { ctree<T>* o = new ctree<T>; assert(o!=0); return o; }
 		
 		branchs& elements()						{ return fElements; }		
 		const branchs& elements() const			{ return fElements; }		
-		virtual void push (const treePtr& t)	{ fElements.push_back(t); }
+		virtual void push (const treePtr& t)	{ t->fParent = static_cast<T*>(this); fElements.push_back(t); modified(); }
+		virtual void push (treePtr&& t)			{ t->fParent = static_cast<T*>(this); fElements.push_back(std::move(t)); modified(); }
+		//! adds a sub element owned by another tree: its parent link is left unchanged
+		virtual void share (const treePtr& t)	{ fElements.push_back(t); modified(); }
+		//! removes the last sub element, has no effect when there is no sub element
+		virtual void pop ()	{
+			if (fElements.empty()) return;
+			if (fElements.back()->fParent == this) fElements.back()->fParent = 0;
+			fElements.pop_back();
+			modified();
+		}
+		//! called when the sub elements are modified, must be called after a direct modification of elements()
+		virtual void modified ()				{}
 		virtual int  size  () const				{ return int(fElements.size()); }
 		virtual bool empty () const				{ return fElements.size()==0; }
+		//! the parent node, null for the root of the tree
+		treePtr		 parent () const			{ return fParent; }
 
 		iterator begin()			{ treePtr start=dynamic_cast<T*>(this); return iterator(start); }
 		iterator end()				{ treePtr start=dynamic_cast<T*>(this); return iterator(start, true); }
+		//! an iterator positioned on a sub element at any depth, end() when \c elt is not part of the tree
+		iterator locate(const treePtr& elt)	{
+			treePtr start=dynamic_cast<T*>(this);
+			iterator i(start, elt);
+			// the parent links of shared sub elements lead to their original tree
+			return (i != end()) ? i : std::find(begin(), end(), elt);
+		}
 		iterator erase(iterator i)	{ return i.erase(); }
 		iterator insert(iterator before, const treePtr& value)	{ return before.insert(value); }
 		
+		//! the subtree elements in document order, e.g. for (T* elt : tree.walk())
+		treeRange<T> walk()			{ return treeRange<T>(static_cast<T*>(this)); }
+
 		literator lbegin() { return fElements.begin(); }
 		literator lend()   { return fElements.end(); }
+		//! looks for a direct sub element, returns lend() when not found
+		virtual literator lfind (const T* elt)	{ return std::find (fElements.begin(), fElements.end(), elt); }
 
 	protected:
-				 ctree() {}
-		virtual ~ctree() {}
+				 ctree() : fParent(0) {}
+		virtual ~ctree() {
+			for (literator i = fElements.begin(); i != fElements.end(); i++)
+				if ((*i)->fParent == this) (*i)->fParent = 0;
+		}
 
 	private:
+		friend class treeIterator<treePtr>;
+
 		branchs	 fElements;
+		T*		 fParent;
 };
 
 
@@ -0,0 +1,765 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <string.h>
+#include <functional>
+#include <queue>
+
+#include "deflate.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// inflate
+//______________________________________________________________________________
+namespace
+{
+
+enum { kMaxBits = 15, kFastBits = 9, kMaxLCodes = 286, kMaxDCodes = 30, kFixedLCodes = 288 };
+
+//______________________________________________________________________________
+// canonical huffman decoding tables
+// codes up to kFastBits long are decoded with a single lookup in the fast table
+// (entries are symbol | length << 9, 0 for longer or invalid codes),
+// longer codes are decoded using the count and symbol tables.
+struct huffman {
+	unsigned short	fast[1 << kFastBits];
+	short			count[kMaxBits+1];
+	short			symbol[kFixedLCodes];
+
+	bool build (const unsigned char* lengths, int n);
+};
+
+//______________________________________________________________________________
+bool huffman::build (const unsigned char* lengths, int n)
+{
+	memset (fast, 0, sizeof(fast));
+	memset (count, 0, sizeof(count));
+	for (int s = 0; s < n; s++)
+		count[lengths[s]]++;
+	if (count[0] == n) return true;		// no code: valid but can't be used for decoding
+
+	int left = 1;
+	for (int len = 1; len <= kMaxBits; len++) {
+		left <<= 1;
+		left -= count[len];
+		if (left < 0) return false;		// over subscribed
+	}
+
+	short offs[kMaxBits+1];
+	offs[1] = 0;
+	for (int len = 1; len < kMaxBits; len++)
+		offs[len + 1] = offs[len] + count[len];
+	for (int s = 0; s < n; s++)
+		if (lengths[s]) symbol[offs[lengths[s]]++] = short(s);
+
+	int next[kMaxBits+1];
+	int code = 0;
+	next[0] = 0;
+	for (int len = 1; len <= kMaxBits; len++) {
+		code = (code + (len > 1 ? count[len-1] : 0)) << 1;
+		next[len] = code;
+	}
+	for (int s = 0; s < n; s++) {
+		int len = lengths[s];
+		if (!len || (len > kFastBits)) continue;
+		int c = next[len]++;
+		int rev = 0;			// huffman codes are stored msb first in the bit stream
+		for (int i = 0; i < len; i++) {
+			rev = (rev << 1) | (c & 1);
+			c >>= 1;
+		}
+		for (int i = rev; i < (1 << kFastBits); i += (1 << len))
+			fast[i] = (unsigned short)(s | (len << 9));
+	}
+	return true;
+}
+
+//______________________________________________________________________________
+static const short kLengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const short kLengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const short kDistBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577 };
+static const short kDistExtra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+//______________________________________________________________________________
+// the inflate state: a 64 bits buffer reading the input, bits are consumed lsb first
+class inflater
+{
+	const unsigned char*	fSrc;
+	size_t					fSrcSize;
+	size_t					fPos;		// may go beyond fSrcSize: zero bits are then provided
+	unsigned long long		fBits;
+	int						fCount;
+
+	unsigned char*	fDst;
+	size_t			fDstSize;
+	size_t			fOut;
+
+	void need (int n) {
+		while (fCount < n) {
+			unsigned long long byte = (fPos < fSrcSize) ? fSrc[fPos] : 0;
+			fPos++;
+			fBits |= byte << fCount;
+			fCount += 8;
+		}
+	}
+	int bits (int n) {
+		need (n);
+		int val = int(fBits & ((1ULL << n) - 1));
+		fBits >>= n;
+		fCount -= n;
+		return val;
+	}
+	bool overrun () const	{ return (fPos - (fCount >> 3)) > fSrcSize; }
+
+	int  decode (const huffman& h);
+	bool stored ();
+	bool codes (const huffman& lcodes, const huffman& dcodes);
+	bool fixed ();
+	bool dynamic ();
+
+	public:
+		inflater (const unsigned char* src, size_t srcsize, unsigned char* dst, size_t dstsize)
+			: fSrc(src), fSrcSize(srcsize), fPos(0), fBits(0), fCount(0), fDst(dst), fDstSize(dstsize), fOut(0) {}
+
+		bool run ();
+};
+
+//______________________________________________________________________________
+int inflater::decode (const huffman& h)
+{
+	need (kMaxBits);
+	unsigned short e = h.fast[fBits & ((1 << kFastBits) - 1)];
+	if (e) {
+		int len = e >> 9;
+		fBits >>= len;
+		fCount -= len;
+		return e & 0x1ff;
+	}
+	int code = 0, first = 0, index = 0;
+	for (int len = 1; len <= kMaxBits; len++) {
+		code |= int((fBits >> (len - 1)) & 1);
+		int count = h.count[len];
+		if (code - first < count) {
+			fBits >>= len;
+			fCount -= len;
+			return h.symbol[index + (code - first)];
+		}
+		index += count;
+		first += count;
+		first <<= 1;
+		code <<= 1;
+	}
+	return -1;		// invalid code
+}
+
+//______________________________________________________________________________
+bool inflater::stored ()
+{
+	// go to the next byte boundary and give back the buffered bytes
+	fBits = 0;
+	fPos -= fCount >> 3;
+	fCount = 0;
+	if (fPos + 4 > fSrcSize) return false;
+	unsigned len  = fSrc[fPos] | (fSrc[fPos+1] << 8);
+	unsigned nlen = fSrc[fPos+2] | (fSrc[fPos+3] << 8);
+	fPos += 4;
+	if (len != (~nlen & 0xffff)) return false;
+	if ((fPos + len > fSrcSize) || (fOut + len > fDstSize)) return false;
+	memcpy (fDst + fOut, fSrc + fPos, len);
+	fPos += len;
+	fOut += len;
+	return true;
+}
+
+//______________________________________________________________________________
+bool inflater::codes (const huffman& lcodes, const huffman& dcodes)
+{
+	for (;;) {
+		int symbol = decode (lcodes);
+		if (symbol < 0) return false;
+		if (symbol < 256) {
+			if (fOut >= fDstSize) return false;
+			fDst[fOut++] = (unsigned char)symbol;
+		}
+		else if (symbol == 256) {
+			return !overrun();
+		}
+		else {
+			symbol -= 257;
+			if (symbol >= 29) return false;
+			size_t len = kLengthBase[symbol] + bits (kLengthExtra[symbol]);
+			symbol = decode (dcodes);
+			if ((symbol < 0) || (symbol >= 30)) return false;
+			size_t dist = kDistBase[symbol] + bits (kDistExtra[symbol]);
+			if ((dist > fOut) || (fOut + len > fDstSize)) return false;
+			unsigned char* to = fDst + fOut;
+			const unsigned char* from = to - dist;
+			if (dist >= len) memcpy (to, from, len);
+			else for (size_t i = 0; i < len; i++) to[i] = from[i];		// overlapping copy
+			fOut += len;
+		}
+	}
+}
+
+//______________________________________________________________________________
+bool inflater::fixed ()
+{
+	struct fixedcodes {
+		huffman lcodes, dcodes;
+		fixedcodes() {
+			unsigned char lengths[kFixedLCodes];
+			int s = 0;
+			for (; s < 144; s++) lengths[s] = 8;
+			for (; s < 256; s++) lengths[s] = 9;
+			for (; s < 280; s++) lengths[s] = 7;
+			for (; s < kFixedLCodes; s++) lengths[s] = 8;
+			lcodes.build (lengths, kFixedLCodes);
+			for (s = 0; s < kMaxDCodes; s++) lengths[s] = 5;
+			dcodes.build (lengths, kMaxDCodes);
+		}
+	};
+	static const fixedcodes tables;
+	return codes (tables.lcodes, tables.dcodes);
+}
+
+//______________________________________________________________________________
+bool inflater::dynamic ()
+{
+	static const short order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	int nlen  = bits (5) + 257;
+	int ndist = bits (5) + 1;
+	int ncode = bits (4) + 4;
+	if ((nlen > kMaxLCodes) || (ndist > kMaxDCodes)) return false;
+
+	unsigned char lengths[kMaxLCodes + kMaxDCodes];
+	memset (lengths, 0, 19);
+	for (int i = 0; i < ncode; i++)
+		lengths[order[i]] = (unsigned char)bits (3);
+	huffman lencode;
+	if (!lencode.build (lengths, 19)) return false;
+
+	int index = 0;
+	while (index < nlen + ndist) {
+		int symbol = decode (lencode);
+		if (symbol < 0) return false;
+		if (symbol < 16) {
+			lengths[index++] = (unsigned char)symbol;
+			continue;
+		}
+		int len = 0;
+		int repeat;
+		if (symbol == 16) {
+			if (index == 0) return false;
+			len = lengths[index - 1];
+			repeat = 3 + bits (2);
+		}
+		else if (symbol == 17) repeat = 3 + bits (3);
+		else repeat = 11 + bits (7);
+		if (index + repeat > nlen + ndist) return false;
+		while (repeat--) lengths[index++] = (unsigned char)len;
+	}
+	if (lengths[256] == 0) return false;	// no end of block code
+
+	huffman lcodes, dcodes;
+	if (!lcodes.build (lengths, nlen)) return false;
+	if (!dcodes.build (lengths + nlen, ndist)) return false;
+	return codes (lcodes, dcodes);
+}
+
+//______________________________________________________________________________
+bool inflater::run ()
+{
+	int last;
+	do {
+		last = bits (1);
+		int type = bits (2);
+		bool ok;
+		switch (type) {
+			case 0:		ok = stored(); break;
+			case 1:		ok = fixed(); break;
+			case 2:		ok = dynamic(); break;
+			default:	ok = false;
+		}
+		if (!ok) return false;
+	} while (!last);
+	return !overrun() && (fOut == fDstSize);
+}
+
+}
+
+//______________________________________________________________________________
+bool inflate (const unsigned char* src, size_t srcsize, unsigned char* dst, size_t dstsize)
+{
+	inflater i (src, srcsize, dst, dstsize);
+	return i.run();
+}
+
+//______________________________________________________________________________
+// deflate
+//______________________________________________________________________________
+namespace
+{
+
+enum { kWindow = 32768, kWindowMask = kWindow - 1, kHashBits = 15,
+	kMinMatch = 3, kMaxMatch = 258, kLookahead = kMaxMatch + kMinMatch + 1, kTooFar = 4096,
+	kMaxChain = 128, kGoodMatch = 8, kMaxLazy = 16, kNiceMatch = 128,		// as zlib level 6
+	kBlockSymbols = 16384, kMaxCLBits = 7, kCLCodes = 19 };
+
+static const short kCLOrder[kCLCodes] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+//______________________________________________________________________________
+// builds the code lengths of a huffman code limited to maxbits:
+// when the code is too long, the frequencies are flattened and the code is rebuilt
+static void buildLengths (const unsigned* freqs, int n, int maxbits, unsigned char* lengths)
+{
+	typedef pair<unsigned long, int> node;		// weight, index
+	vector<unsigned long> f (freqs, freqs + n);
+	vector<int> parent (2 * n);
+	vector<int> depth (2 * n);
+	for (;;) {
+		priority_queue<node, vector<node>, greater<node> > q;
+		for (int s = 0; s < n; s++)
+			if (f[s]) q.push (node(f[s], s));
+		memset (lengths, 0, n);
+		if (q.empty()) return;
+		if (q.size() == 1) {
+			lengths[q.top().second] = 1;
+			return;
+		}
+		int next = n;
+		while (q.size() > 1) {
+			node a = q.top(); q.pop();
+			node b = q.top(); q.pop();
+			parent[a.second] = parent[b.second] = next;
+			q.push (node(a.first + b.first, next++));
+		}
+		// the parents are created after their children: the depths are computed from the root
+		int root = next - 1;
+		depth[root] = 0;
+		for (int i = root - 1; i >= n; i--)
+			depth[i] = depth[parent[i]] + 1;
+		int max = 0;
+		for (int s = 0; s < n; s++)
+			if (f[s]) {
+				int d = depth[parent[s]] + 1;
+				lengths[s] = (unsigned char)d;
+				if (d > max) max = d;
+			}
+		if (max <= maxbits) return;
+		for (int s = 0; s < n; s++)
+			if (f[s]) f[s] = (f[s] >> 1) | 1;
+	}
+}
+
+//______________________________________________________________________________
+// gives the canonical codes of a set of code lengths, bit reversed for the output
+static void buildCodes (const unsigned char* lengths, int n, unsigned short* codes)
+{
+	int count[kMaxBits+1];
+	memset (count, 0, sizeof(count));
+	for (int s = 0; s < n; s++)
+		count[lengths[s]]++;
+	count[0] = 0;
+	int next[kMaxBits+1];
+	int code = 0;
+	for (int len = 1; len <= kMaxBits; len++) {
+		code = (code + count[len-1]) << 1;
+		next[len] = code;
+	}
+	for (int s = 0; s < n; s++) {
+		int len = lengths[s];
+		if (!len) continue;
+		int c = next[len]++;
+		int rev = 0;
+		for (int i = 0; i < len; i++) {
+			rev = (rev << 1) | (c & 1);
+			c >>= 1;
+		}
+		codes[s] = (unsigned short)rev;
+	}
+}
+
+//______________________________________________________________________________
+// the length and distance codes lookup and the fixed huffman codes
+struct encodetables {
+	unsigned char	lengthCode[kMaxMatch + 1];
+	unsigned char	distCode[512];		// dist - 1 below 256, 256 + ((dist - 1) >> 7) above
+	unsigned char	fixedLengths[kFixedLCodes];
+	unsigned short	fixedCodes[kFixedLCodes];
+	unsigned char	fixedDistLengths[kMaxDCodes];
+	unsigned short	fixedDistCodes[kMaxDCodes];
+
+	encodetables() {
+		for (int c = 0; c < 29; c++)
+			for (int l = kLengthBase[c]; (l < kLengthBase[c] + (1 << kLengthExtra[c])) && (l <= kMaxMatch); l++)
+				lengthCode[l] = (unsigned char)c;
+		for (int c = 0; c < kMaxDCodes; c++)
+			for (int d = kDistBase[c] - 1; d < kDistBase[c] - 1 + (1 << kDistExtra[c]); d++)
+				distCode[d < 256 ? d : 256 + (d >> 7)] = (unsigned char)c;
+		int s = 0;
+		for (; s < 144; s++) fixedLengths[s] = 8;
+		for (; s < 256; s++) fixedLengths[s] = 9;
+		for (; s < 280; s++) fixedLengths[s] = 7;
+		for (; s < kFixedLCodes; s++) fixedLengths[s] = 8;
+		buildCodes (fixedLengths, kFixedLCodes, fixedCodes);
+		memset (fixedDistLengths, 5, kMaxDCodes);
+		buildCodes (fixedDistLengths, kMaxDCodes, fixedDistCodes);
+	}
+	int dist (unsigned d) const		{ d--; return distCode[d < 256 ? d : 256 + (d >> 7)]; }
+};
+
+static const encodetables& tables ()
+{
+	static const encodetables t;
+	return t;
+}
+
+}
+
+//______________________________________________________________________________
+deflater::deflater (string& out)
+	: fOut(out), fWindow(2 * kWindow), fHead(1 << kHashBits), fPrev(kWindow), fPos(0), fEnd(0),
+	  fPending(false), fPrevLength(0), fPrevDist(0), fBits(0), fBitCount(0), fFinished(false)
+{
+	fLengths.reserve (kBlockSymbols);
+	fDists.reserve (kBlockSymbols);
+	tables();
+}
+
+//______________________________________________________________________________
+void deflater::flushBits (bool all)
+{
+	char bytes[8];
+	int n = 0;
+	while (fBitCount >= 8) {
+		bytes[n++] = char(fBits & 0xff);
+		fBits >>= 8;
+		fBitCount -= 8;
+	}
+	if (all && fBitCount) {
+		bytes[n++] = char(fBits & 0xff);
+		fBits = 0;
+		fBitCount = 0;
+	}
+	fOut.append (bytes, n);
+}
+
+//______________________________________________________________________________
+// inserts a position in the hash chains, gives the previous head of its chain
+unsigned deflater::insert (size_t pos)
+{
+	const unsigned char* p = &fWindow[pos];
+	unsigned h = ((unsigned(p[0]) | (unsigned(p[1]) << 8) | (unsigned(p[2]) << 16)) * 2654435761U) >> (32 - kHashBits);
+	unsigned head = fHead[h];
+	fPrev[pos & kWindowMask] = head;
+	fHead[h] = unsigned(pos + 1);
+	return head;
+}
+
+//______________________________________________________________________________
+// looks for a match at fPos longer than the pending one, returns 0 when none
+unsigned deflater::longest (size_t candidate, unsigned& dist) const
+{
+	size_t maxlen = fEnd - fPos;
+	if (maxlen > kMaxMatch) maxlen = kMaxMatch;
+	unsigned best = (fPending && (fPrevLength >= kMinMatch)) ? fPrevLength : kMinMatch - 1;
+	if (best >= maxlen) return 0;
+
+	unsigned chain = (best >= kGoodMatch) ? kMaxChain >> 2 : kMaxChain;
+	size_t stop = (fPos > kWindow) ? fPos - kWindow : 0;
+	const unsigned char* scan = &fWindow[fPos];
+	unsigned found = 0;
+	while (candidate >= stop) {
+		const unsigned char* m = &fWindow[candidate];
+		if ((m[best] == scan[best]) && (m[0] == scan[0]) && (m[1] == scan[1])) {
+			unsigned len = 2;
+			while ((len < maxlen) && (m[len] == scan[len])) len++;
+			if (len > best) {
+				best = found = len;
+				dist = unsigned(fPos - candidate);
+				if ((len >= kNiceMatch) || (len >= maxlen)) break;
+			}
+		}
+		unsigned prev = fPrev[candidate & kWindowMask];
+		if (!prev || (prev - 1 >= candidate) || !--chain) break;		// end of chain or stale entry
+		candidate = prev - 1;
+	}
+	if ((found == kMinMatch) && (dist > kTooFar)) return 0;		// a literal is shorter
+	return found;
+}
+
+//______________________________________________________________________________
+void deflater::symbol (unsigned length, unsigned dist)
+{
+	fLengths.push_back ((unsigned short)length);
+	fDists.push_back ((unsigned short)dist);
+	if (fLengths.size() >= kBlockSymbols) block (false);
+}
+
+//______________________________________________________________________________
+// compresses the data, up to the lookahead needed by the matches unless flushing
+void deflater::compress (bool flush)
+{
+	size_t limit = flush ? fEnd : ((fEnd > kLookahead) ? fEnd - kLookahead : 0);
+	while (fPos < limit) {
+		unsigned length = 0, dist = 0;
+		if (fPos + kMinMatch <= fEnd) {
+			unsigned head = insert (fPos);
+			if (head && (fPrevLength < kMaxLazy)) length = longest (head - 1, dist);
+		}
+		if (fPending && (fPrevLength >= kMinMatch) && (length <= fPrevLength)) {
+			// the match at fPos - 1 is kept, fPos - 1 and fPos are already inserted
+			symbol (fPrevLength, fPrevDist);
+			size_t end = fPos - 1 + fPrevLength;
+			for (fPos++; fPos < end; fPos++)
+				if (fPos + kMinMatch <= fEnd) insert (fPos);
+			fPending = false;
+			fPrevLength = 0;
+		}
+		else {
+			if (fPending) symbol (fWindow[fPos - 1], 0);
+			fPending = true;
+			fPrevLength = length;
+			fPrevDist = dist;
+			fPos++;
+		}
+	}
+	if (flush && fPending) {
+		symbol (fWindow[fPos - 1], 0);
+		fPending = false;
+		fPrevLength = 0;
+	}
+}
+
+//______________________________________________________________________________
+// moves the window upper half down, positions below are dropped from the hash chains
+void deflater::slide ()
+{
+	memmove (&fWindow[0], &fWindow[kWindow], kWindow);
+	fPos -= kWindow;
+	fEnd -= kWindow;
+	for (vector<unsigned>::iterator i = fHead.begin(); i != fHead.end(); i++)
+		*i = (*i > kWindow) ? *i - kWindow : 0;
+	for (vector<unsigned>::iterator i = fPrev.begin(); i != fPrev.end(); i++)
+		*i = (*i > kWindow) ? *i - kWindow : 0;
+}
+
+//______________________________________________________________________________
+void deflater::write (const unsigned char* data, size_t size)
+{
+	while (size) {
+		if (fEnd == fWindow.size()) {
+			compress (false);
+			slide ();
+		}
+		size_t n = fWindow.size() - fEnd;
+		if (n > size) n = size;
+		memcpy (&fWindow[fEnd], data, n);
+		fEnd += n;
+		data += n;
+		size -= n;
+	}
+}
+
+//______________________________________________________________________________
+void deflater::finish ()
+{
+	if (fFinished) return;
+	compress (true);
+	block (true);
+	flushBits (true);
+	fFinished = true;
+}
+
+//______________________________________________________________________________
+// encodes the pending symbols as a block
+void deflater::block (bool last)
+{
+	const encodetables& t = tables();
+	size_t n = fLengths.size();
+
+	unsigned lfreq[kMaxLCodes], dfreq[kMaxDCodes];
+	memset (lfreq, 0, sizeof(lfreq));
+	memset (dfreq, 0, sizeof(dfreq));
+	unsigned long extra = 0;		// the extra bits, common to the dynamic and fixed codes
+	for (size_t i = 0; i < n; i++) {
+		if (!fDists[i]) lfreq[fLengths[i]]++;
+		else {
+			int lc = t.lengthCode[fLengths[i]];
+			int dc = t.dist (fDists[i]);
+			lfreq[257 + lc]++;
+			dfreq[dc]++;
+			extra += kLengthExtra[lc] + kDistExtra[dc];
+		}
+	}
+	lfreq[256] = 1;
+
+	// dynamic codes: at least 2 codes are built for each alphabet to keep the codes complete
+	unsigned char lengths[kMaxLCodes + kMaxDCodes];
+	unsigned char* llen = lengths;
+	unsigned char* dlen = lengths + kMaxLCodes;
+	unsigned f[kMaxLCodes];
+	memcpy (f, lfreq, sizeof(lfreq));
+	if (!f[0]) f[0] = 1;
+	buildLengths (f, kMaxLCodes, kMaxBits, llen);
+	memcpy (f, dfreq, sizeof(dfreq));
+	if (!f[0]) f[0] = 1;
+	if (!f[1]) f[1] = 1;
+	buildLengths (f, kMaxDCodes, kMaxBits, dlen);
+
+	int nlen = kMaxLCodes;
+	while ((nlen > 257) && !llen[nlen - 1]) nlen--;
+	int ndist = kMaxDCodes;
+	while ((ndist > 1) && !dlen[ndist - 1]) ndist--;
+	memmove (lengths + nlen, dlen, ndist);		// the lengths are sent as a single sequence
+	dlen = lengths + nlen;
+
+	// run length encoding of the code lengths
+	vector<unsigned char> rle, rleExtra;
+	int total = nlen + ndist;
+	for (int i = 0; i < total; ) {
+		unsigned char v = lengths[i];
+		int run = 1;
+		while ((i + run < total) && (lengths[i + run] == v)) run++;
+		i += run;
+		if (!v) {
+			while (run >= 11) {
+				int r = (run < 138) ? run : 138;
+				rle.push_back (18); rleExtra.push_back ((unsigned char)(r - 11));
+				run -= r;
+			}
+			if (run >= 3) {
+				rle.push_back (17); rleExtra.push_back ((unsigned char)(run - 3));
+				run = 0;
+			}
+		}
+		else {
+			rle.push_back (v); rleExtra.push_back (0);
+			run--;
+			while (run >= 3) {
+				int r = (run < 6) ? run : 6;
+				rle.push_back (16); rleExtra.push_back ((unsigned char)(r - 3));
+				run -= r;
+			}
+		}
+		while (run-- > 0) { rle.push_back (v); rleExtra.push_back (0); }
+	}
+	unsigned clfreq[kCLCodes];
+	memset (clfreq, 0, sizeof(clfreq));
+	for (size_t i = 0; i < rle.size(); i++)
+		clfreq[rle[i]]++;
+	unsigned char cllen[kCLCodes];
+	buildLengths (clfreq, kCLCodes, kMaxCLBits, cllen);
+	int ncl = kCLCodes;
+	while ((ncl > 4) && !cllen[kCLOrder[ncl - 1]]) ncl--;
+
+	// the dynamic and fixed codes sizes
+	unsigned long dynamicBits = 5 + 5 + 4 + 3 * ncl;
+	for (int s = 0; s < kCLCodes; s++)
+		dynamicBits += clfreq[s] * cllen[s];
+	dynamicBits += clfreq[16] * 2 + clfreq[17] * 3 + clfreq[18] * 7;
+	unsigned long fixedBits = 0;
+	for (int s = 0; s < nlen; s++) {
+		dynamicBits += lfreq[s] * llen[s];
+		fixedBits += lfreq[s] * t.fixedLengths[s];
+	}
+	for (int s = 0; s < ndist; s++) {
+		dynamicBits += dfreq[s] * dlen[s];
+		fixedBits += dfreq[s] * 5;
+	}
+
+	unsigned short lcodes[kMaxLCodes], dcodes[kMaxDCodes];
+	const unsigned short* lc = t.fixedCodes;
+	const unsigned char* ll = t.fixedLengths;
+	const unsigned short* dc = t.fixedDistCodes;
+	const unsigned char* dl = t.fixedDistLengths;
+	put (last ? 1 : 0, 1);
+	if (dynamicBits < fixedBits) {
+		put (2, 2);
+		put (nlen - 257, 5);
+		put (ndist - 1, 5);
+		put (ncl - 4, 4);
+		for (int i = 0; i < ncl; i++)
+			put (cllen[kCLOrder[i]], 3);
+		unsigned short clcodes[kCLCodes];
+		buildCodes (cllen, kCLCodes, clcodes);
+		for (size_t i = 0; i < rle.size(); i++) {
+			int s = rle[i];
+			put (clcodes[s], cllen[s]);
+			if (s == 16) put (rleExtra[i], 2);
+			else if (s == 17) put (rleExtra[i], 3);
+			else if (s == 18) put (rleExtra[i], 7);
+		}
+		buildCodes (llen, nlen, lcodes);
+		buildCodes (dlen, ndist, dcodes);
+		lc = lcodes; ll = llen;
+		dc = dcodes; dl = dlen;
+	}
+	else put (1, 2);
+
+	for (size_t i = 0; i < n; i++) {
+		unsigned length = fLengths[i];
+		unsigned dist = fDists[i];
+		if (!dist) put (lc[length], ll[length]);
+		else {
+			int code = t.lengthCode[length];
+			put (lc[257 + code], ll[257 + code]);
+			if (kLengthExtra[code]) put (length - kLengthBase[code], kLengthExtra[code]);
+			code = t.dist (dist);
+			put (dc[code], dl[code]);
+			if (kDistExtra[code]) put (dist - kDistBase[code], kDistExtra[code]);
+		}
+	}
+	put (lc[256], ll[256]);
+	fLengths.clear();
+	fDists.clear();
+}
+
+//______________________________________________________________________________
+// crc32
+//______________________________________________________________________________
+unsigned long crc32 (unsigned long crc, const unsigned char* data, size_t size)
+{
+	struct crctable {
+		unsigned long values[256];
+		crctable() {
+			for (unsigned long n = 0; n < 256; n++) {
+				unsigned long c = n;
+				for (int k = 0; k < 8; k++)
+					c = (c & 1) ? (0xedb88320UL ^ (c >> 1)) : (c >> 1);
+				values[n] = c;
+			}
+		}
+	};
+	static const crctable table;
+
+	crc = crc ^ 0xffffffffUL;
+	while (size--)
+		crc = table.values[(crc ^ *data++) & 0xff] ^ (crc >> 8);
+	return crc ^ 0xffffffffUL;
+}
+
+}
@@ -0,0 +1,99 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __deflate__
+#define __deflate__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace MusicXML2
+{
+
+/*!
+\internal
+\brief decompresses a raw deflate stream (RFC 1951) into a buffer.
+
+	\param src the compressed data
+	\param srcsize the compressed data size
+	\param dst the destination buffer
+	\param dstsize the expected size of the decompressed data
+	\return true when the stream is valid and decompresses exactly to dstsize bytes
+*/
+bool inflate (const unsigned char* src, size_t srcsize, unsigned char* dst, size_t dstsize);
+
+/*!
+\internal
+\brief compresses a data stream to a raw deflate stream (RFC 1951).
+
+	The data is compressed while written: the matches are searched in a 32 kB
+	sliding window using hash chains and a one step lazy evaluation, the symbols
+	are encoded by blocks using dynamic or fixed huffman codes, whichever is shorter.
+	The compressed data is appended to the output string, which can be emptied by
+	the client between the calls.
+*/
+class deflater
+{
+	public:
+				 deflater (std::string& out);
+		virtual ~deflater () {}
+
+		//! compresses a data block
+		void	write (const unsigned char* data, size_t size);
+		//! compresses the remaining data and terminates the stream
+		void	finish ();
+
+	private:
+		std::string&				fOut;
+		std::vector<unsigned char>	fWindow;	// the history and the data to compress
+		std::vector<unsigned>		fHead;		// the last position + 1 of each hash value, 0 when none
+		std::vector<unsigned>		fPrev;		// the previous position + 1 with the same hash
+		size_t						fPos;		// the next position to compress
+		size_t						fEnd;		// the end of the data
+		bool						fPending;	// a symbol is pending at fPos - 1 (lazy evaluation)
+		unsigned					fPrevLength;
+		unsigned					fPrevDist;
+		std::vector<unsigned short>	fLengths;	// the current block symbols: literals or match lengths
+		std::vector<unsigned short>	fDists;		// the match distances, 0 for literals
+		unsigned long long			fBits;
+		int							fBitCount;
+		bool						fFinished;
+
+		void		put (unsigned value, int n) {
+			fBits |= (unsigned long long)value << fBitCount;
+			fBitCount += n;
+			if (fBitCount >= 32) flushBits (false);
+		}
+		void		flushBits (bool all);
+		unsigned	insert (size_t pos);
+		unsigned	longest (size_t candidate, unsigned& dist) const;
+		void		symbol (unsigned length, unsigned dist);
+		void		compress (bool flush);
+		void		slide ();
+		void		block (bool last);
+
+				 deflater (const deflater&);				// not copyable
+		deflater&	operator= (const deflater&);
+};
+
+/*!
+\internal
+\brief computes the crc-32 of a data block (as used by the zip format).
+
+	\param crc the crc of the previous data (0 for the first block)
+*/
+unsigned long crc32 (unsigned long crc, const unsigned char* data, size_t size);
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "nametable.h"
+
+using namespace std;
+
+namespace MusicXML2 
+{
+
+//______________________________________________________________________________
+// the shared table is protected by a mutex, each thread keeps a cache of the
+// names it has already looked up to avoid locking for every name.
+// the shared table is never destroyed: cached names may be used by threads
+// that terminate after the static objects destruction.
+namespace
+{
+	struct sharedtable {
+		mutex					fMutex;
+		unordered_set<string>	fNames;
+	};
+
+	sharedtable& shared ()
+	{
+		static sharedtable* table = new sharedtable;
+		return *table;
+	}
+
+	typedef unordered_map<string, nametable::name> namescache;
+	thread_local namescache gCache;
+}
+
+//______________________________________________________________________________
+nametable::name nametable::intern (const string& str)
+{
+	namescache::const_iterator i = gCache.find (str);
+	if (i != gCache.end()) return i->second;
+
+	sharedtable& table = shared();
+	lock_guard<mutex> lock (table.fMutex);
+	name n = &(*table.fNames.insert (str).first);		// elements of unordered_set are never moved
+	gCache[str] = n;
+	return n;
+}
+
+//______________________________________________________________________________
+nametable::name nametable::find (const string& str)
+{
+	namescache::const_iterator i = gCache.find (str);
+	if (i != gCache.end()) return i->second;
+
+	sharedtable& table = shared();
+	lock_guard<mutex> lock (table.fMutex);
+	unordered_set<string>::const_iterator n = table.fNames.find (str);
+	if (n == table.fNames.end()) return 0;
+	gCache[str] = &(*n);
+	return &(*n);
+}
+
+//______________________________________________________________________________
+nametable::name nametable::empty ()
+{
+	static name e = intern ("");
+	return e;
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __nametable__
+#define __nametable__
+
+#include <string>
+#include "exports.h"
+
+namespace MusicXML2 
+{
+
+/*!
+\brief a global table of unique strings, used for the elements and attributes names.
+
+	An interned name is a pointer to the unique copy of a string: interned names
+	can be compared by pointer. Names are never removed from the table, they remain
+	valid until the program ends. The table can be used concurrently from different threads.
+*/
+class EXP nametable {
+	public:
+		typedef const std::string* name;
+
+		//! gives the unique copy of a string, it is created when necessary
+		static name	intern (const std::string& str);
+		//! gives the unique copy of a string, or 0 when the string has not been interned
+		static name	find (const std::string& str);
+		//! the interned empty string
+		static name	empty ();
+};
+
+}
+
+#endif
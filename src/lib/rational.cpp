@@ -12,12 +12,14 @@
 
 #include "rational.h"
 #include <sstream>
+#include <cassert>
 #include <cmath>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
 //______________________________________________________________________________
-rational::rational (const string &str)
+rational::rational (const string &str) : fNumerator(0), fDenominator(1)
 {
   const char *cstr;
   cstr = str.c_str();
@@ -26,104 +28,153 @@ rational::rational (const string &str)
   if (denom) ++denom;
   fNumerator = atol(cstr);
   if (denom) fDenominator = atol(denom);
-}
-
-rational::rational(long int num, long int denom) : fNumerator(num), fDenominator(denom)
-{
-  // don't allow zero denominators!
   if (fDenominator == 0) fDenominator = 1;
 }
 
-rational::rational(const rational& d)
+//______________________________________________________________________________
+// binary gcd: uses shifts and subtractions only
+static inline int trailingZeros (unsigned long n)
 {
-  fNumerator   = d.fNumerator;
-  fDenominator = d.fDenominator;
+#if defined(__GNUC__)
+	return __builtin_ctzl (n);
+#else
+	int count = 0;
+	while (!(n & 1)) { n >>= 1; count++; }
+	return count;
+#endif
 }
 
-//______________________________________________________________________________
-rational rational::operator +(const rational &dur) const {
-    return rational(fNumerator * dur.fDenominator + dur.fNumerator * fDenominator, fDenominator * dur.fDenominator);
-}
+// the terms must be non null
+static inline unsigned long binaryGcd (unsigned long a, unsigned long b)
+{
+	// a first euclidean step brings the greater term (usually a position numerator)
+	// down to the scale of the smaller one (usually a denominator)
+	if (a > b) { a %= b; if (a == 0) return b; }
+	else { b %= a; if (b == 0) return a; }
 
-rational rational::operator -(const rational &dur) const {
-    return rational(fNumerator * dur.fDenominator - dur.fNumerator * fDenominator, fDenominator * dur.fDenominator);
+	int shift = trailingZeros (a | b);
+	a >>= trailingZeros (a);
+	do {
+		b >>= trailingZeros (b);
+		if (a > b) { unsigned long t = a; a = b; b = t; }
+		b -= a;
+	} while (b);
+	return a << shift;
 }
 
-rational rational::operator *(const rational &dur) const {
-    return rational(fNumerator * dur.fNumerator, fDenominator * dur.fDenominator);
+long int rational::gcd (long int a1, long int b1)
+{
+	unsigned long a = (a1 < 0) ? 0 - (unsigned long)a1 : (unsigned long)a1;
+	unsigned long b = (b1 < 0) ? 0 - (unsigned long)b1 : (unsigned long)b1;
+	if (a == 0) return b ? long(b) : 1;
+	if (b == 0) return long(a);
+	return long(binaryGcd (a, b));
 }
 
-rational rational::operator /(const rational &dur) const {
-    return rational(fNumerator * dur.fDenominator, fDenominator * dur.fNumerator);
+//______________________________________________________________________________
+// exact division of the terms by their gcd: durations denominators are mostly
+// powers of 2, and divisions are cheaper on 32 bits
+static inline void divide (long& n, long& d, long g)
+{
+	if ((g & (g - 1)) == 0) {
+		int shift = trailingZeros ((unsigned long)g);
+		n = (n < 0) ? -long((0 - (unsigned long)n) >> shift) : long((unsigned long)n >> shift);
+		d >>= shift;
+	}
+	else if ((n >= INT_MIN) && (n <= INT_MAX) && (d <= INT_MAX)) {
+		n = int(n) / int(g);
+		d = int(d) / int(g);
+	}
+	else { n /= g; d /= g; }
 }
 
-rational rational::operator *(int num) const {
-	return rational(fNumerator * num, fDenominator);
+//______________________________________________________________________________
+// the terms are reduced using long ints when they fit, which is the common case
+inline void rational::reduce (wideint num, wideint denom)
+{
+	if (denom == 0) denom = 1;				// as the constructor does
+	if (denom < 0) { num = -num; denom = -denom; }
+	if (num == 0) {
+		fNumerator = 0;
+		fDenominator = 1;
+		return;
+	}
+	if ((num > LONG_MIN) && (num <= LONG_MAX) && (denom <= LONG_MAX)) {
+		long n = long(num), d = long(denom);
+		long g = long(binaryGcd ((n < 0) ? 0 - (unsigned long)n : (unsigned long)n, (unsigned long)d));
+		if (g != 1) divide (n, d, g);		// the terms are often already coprime
+		fNumerator = n;
+		fDenominator = d;
+		return;
+	}
+	wideint a = (num < 0) ? -num : num, b = denom;
+	while (b) { wideint r = a % b; a = b; b = r; }
+	num /= a;
+	denom /= a;
+	// the reduced terms must fit in long: a truncation would silently change the value
+	assert ((num >= LONG_MIN) && (num <= LONG_MAX) && (denom <= LONG_MAX));
+	fNumerator = long(num);
+	fDenominator = long(denom);
 }
 
-rational rational::operator /(int num) const {
-	return rational(fNumerator, fDenominator * num);
-}
+//______________________________________________________________________________
+rational rational::operator +(const rational &dur) const	{ rational r(*this); return r += dur; }
+rational rational::operator -(const rational &dur) const	{ rational r(*this); return r -= dur; }
+rational rational::operator *(const rational &dur) const	{ rational r(*this); return r *= dur; }
+rational rational::operator /(const rational &dur) const	{ rational r(*this); return r /= dur; }
+rational rational::operator *(int num) const				{ rational r(*this); return r *= long(num); }
+rational rational::operator /(int num) const				{ rational r(*this); return r /= long(num); }
 
+//______________________________________________________________________________
 rational& rational::operator +=(const rational &dur)
 {
-  if(fDenominator == dur.fDenominator) {
-		fNumerator += dur.fNumerator;
-	} else {
-		fNumerator = fNumerator * dur.fDenominator + dur.fNumerator * fDenominator;
-		fDenominator *= dur.fDenominator;
-	}
-    return (*this);
+	if (fDenominator == dur.fDenominator)
+		reduce (wideint(fNumerator) + dur.fNumerator, fDenominator);
+	else
+		reduce (wideint(fNumerator) * dur.fDenominator + wideint(dur.fNumerator) * fDenominator, wideint(fDenominator) * dur.fDenominator);
+	return (*this);
 }
 
 rational& rational::operator -=(const rational &dur)
 {
-	if(fDenominator == dur.fDenominator) {
-		fNumerator -= dur.fNumerator;
-	} else {
-		fNumerator = fNumerator * dur.fDenominator - dur.fNumerator * fDenominator;
-		fDenominator *= dur.fDenominator;
-    }
+	if (fDenominator == dur.fDenominator)
+		reduce (wideint(fNumerator) - dur.fNumerator, fDenominator);
+	else
+		reduce (wideint(fNumerator) * dur.fDenominator - wideint(dur.fNumerator) * fDenominator, wideint(fDenominator) * dur.fDenominator);
 	return (*this);
 }
 
 rational& rational::operator *=(const rational &dur)
 {
-    fNumerator   *= dur.fNumerator;
-    fDenominator *= dur.fDenominator;
-    return (*this);
+	reduce (wideint(fNumerator) * dur.fNumerator, wideint(fDenominator) * dur.fDenominator);
+	return (*this);
 }
 
 rational& rational::operator /=(const rational &dur)
 {
-    fNumerator   *= dur.fDenominator;
-    fDenominator *= dur.fNumerator;
-    return (*this);
+	reduce (wideint(fNumerator) * dur.fDenominator, wideint(fDenominator) * dur.fNumerator);
+	return (*this);
 }
 
-rational& rational::operator = (const rational& rat) {
-  fNumerator   = rat.fNumerator;
-  fDenominator = rat.fDenominator;
-  return (*this);
-}
+rational& rational::operator *=(long int num)	{ reduce (wideint(fNumerator) * num, fDenominator); return (*this); }
+rational& rational::operator /=(long int num)	{ reduce (fNumerator, wideint(fDenominator) * num); return (*this); }
 
 //______________________________________________________________________________
-bool rational::operator > (const rational &rat) const
-{
-  // a/b > c/d if and only if a * d > b * c.
-  return ((fNumerator * rat.fDenominator) > (fDenominator * rat.fNumerator));
-}
-
+// a/b < c/d if and only if a * d < b * c when b * d is positive
 bool rational::operator < (const rational &rat) const
 {
-  // a/b < c/d if and only if a * d < b * c.
-  return ((fNumerator * rat.fDenominator) < (fDenominator * rat.fNumerator));
+	if ((fDenominator == rat.fDenominator) && (fDenominator > 0))
+		return fNumerator < rat.fNumerator;
+	wideint l = wideint(fNumerator) * rat.fDenominator;
+	wideint r = wideint(rat.fNumerator) * fDenominator;
+	return ((fDenominator < 0) != (rat.fDenominator < 0)) ? (r < l) : (l < r);
 }
 
 bool rational::operator == (const rational &rat) const
 {
-  // a/b < c/d if and only if a * d < b * c.
-	return ((fNumerator * rat.fDenominator) == (fDenominator * rat.fNumerator));
+	if (fDenominator == rat.fDenominator)
+		return fNumerator == rat.fNumerator;
+	return (wideint(fNumerator) * rat.fDenominator) == (wideint(rat.fNumerator) * fDenominator);
 }
 
 bool rational::operator > (double num) const 	{ return (toDouble() > num); }
@@ -132,38 +183,10 @@ bool rational::operator < (double num) const	{ return (toDouble() < num); }
 bool rational::operator <= (double num) const	{ return (toDouble() <= num); }
 bool rational::operator == (double num) const	{ return (toDouble() == num); }
 
-//______________________________________________________________________________
-// gcd(a, b) calculates the gcd of a and b using Euclid's algorithm.
-long int rational::gcd (long int a1, long int b1)
-{
-  long int r;
-
-  long int a = labs(a1);
-  long int b = labs(b1);
-
-  if (! (a == 0) || (b == 0)) {
-    while (b > 0){
-      r = a % b;
-      a = b;
-      b = r;
-    } // while
-
-    return a;
-  }
-
-  return 1;
-}
-
 //______________________________________________________________________________
 void rational::rationalise ()
 {
-  long int g = gcd (fNumerator, fDenominator);
-
-  fNumerator /= g;
-  fDenominator /= g;
-
-  if (fNumerator == 0)
-    fDenominator = 1;
+	reduce (fNumerator, fDenominator);
 }
 
 //______________________________________________________________________________
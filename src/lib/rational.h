@@ -20,26 +20,39 @@ using namespace std;
 
 /*!
 \brief	Rational number representation.
+
+	The terms given at construction time are kept as is, since rationals are also
+	used to represent time signatures or tuplets ratios (e.g. 6/8 or 2/2).
+	The results of the arithmetic operations are always normalized: the terms have
+	no common divisor and the denominator is positive. The intermediate products
+	are computed using 128 bits integers when available, comparisons are exact.
 */
 
 class EXP rational {
 
    private:    
-   
+#if defined(__SIZEOF_INT128__)
+		__extension__ typedef __int128	wideint;
+#else
+		typedef long long				wideint;	// only wider than long where long is 32 bits (e.g. ILP32, LLP64): on LP64 the products may overflow
+#endif
+
         long int fNumerator;
         long int fDenominator;        
         
         // Used by rationalise()
-        long int gcd(long int a, long int b); 
+        static long int gcd(long int a, long int b); 
+        //! sets the normalized value of num / denom
+        void	reduce (wideint num, wideint denom);
  
     public:    
 	
-        rational(long int num = 0, long int denom = 1);
-        rational(const rational& d);
+        constexpr rational(long int num = 0, long int denom = 1) : fNumerator(num), fDenominator(denom ? denom : 1) {}
+        rational(const rational& d) = default;
         rational(const string &str);
     
-        long int getNumerator()	const		{ return fNumerator; }
-        long int getDenominator() const		{ return fDenominator; }
+        constexpr long int getNumerator()	const		{ return fNumerator; }
+        constexpr long int getDenominator() const		{ return fDenominator; }
         void setNumerator(long int d)		{ fNumerator = d; }
         void setDenominator(long int d) 	{ fDenominator = d; }
 		void set(long int n, long int d)  { fNumerator = n; fDenominator = d; }
@@ -61,15 +74,15 @@ class EXP rational {
         rational& operator /=(const rational &dur);
         // (i.e. dur * 3/2 or dur * 7/4)
 
-        rational& operator *=(long int num) { fNumerator *= num; return *this; }
-        rational& operator /=(long int num) { fDenominator *= num; return *this; }
+        rational& operator *=(long int num);
+        rational& operator /=(long int num);
  
-        rational& operator =(const rational& dur);
+        rational& operator =(const rational& dur) = default;
     
-        bool operator >(const rational &dur) const;
+        bool operator >(const rational &dur) const		{return dur < *this;}
         bool operator >=(const rational &dur) const 	{return !(*this < dur);}
         bool operator <(const rational &dur) const;
-        bool operator <=(const rational &dur) const 	{return !(*this > dur);}
+        bool operator <=(const rational &dur) const 	{return !(dur < *this);}
             
         bool operator ==(const rational &dur) const;
         bool operator !=(const rational &dur) const	{return !(*this == dur);}
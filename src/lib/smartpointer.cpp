@@ -0,0 +1,22 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include "smartpointer.h"
+
+namespace MusicXML2 
+{
+
+std::atomic<bool> smartable::fConcurrent (false);
+
+void smartable::concurrent (bool state)		{ fConcurrent.store (state, std::memory_order_relaxed); }
+
+}
@@ -14,6 +14,8 @@
 #define __smartpointer__
 
 #include <cassert>
+#include <utility>
+#include <atomic>
 #include "exports.h"
 
 namespace MusicXML2 
@@ -25,17 +27,45 @@ namespace MusicXML2
 	Any object that want to support smart pointers should
 	inherit from the smartable class which provides reference counting
 	and automatic delete when the reference count drops to zero.
+
+	The reference count is always an atomic counter. Updates are atomic read-modify-write
+	operations once the concurrent mode is set (see concurrent()): a tree can then be
+	shared by several threads (e.g. browsed concurrently by different visitors).
+	Otherwise, the count is updated with plain loads and stores.
 */
 class EXP smartable {
 	private:
-		unsigned 	refCount;		
+		std::atomic<unsigned>	refCount;
+		static std::atomic<bool>	fConcurrent;
+
+		static bool	isConcurrent ()	{ return fConcurrent.load (std::memory_order_relaxed); }
+
+		unsigned	increment ()	{
+			if (isConcurrent()) return refCount.fetch_add (1, std::memory_order_relaxed) + 1;
+			unsigned n = refCount.load (std::memory_order_relaxed) + 1;
+			refCount.store (n, std::memory_order_relaxed);
+			return n;
+		}
+		unsigned	decrement ()	{
+			if (isConcurrent()) return refCount.fetch_sub (1, std::memory_order_acq_rel) - 1;
+			unsigned n = refCount.load (std::memory_order_relaxed) - 1;
+			refCount.store (n, std::memory_order_relaxed);
+			return n;
+		}
+
 	public:
 		//! gives the reference count of the object
 		unsigned refs() const         { return refCount; }
 		//! addReference increments the ref count and checks for refCount overflow
-		void addReference()           { refCount++; assert(refCount != 0); }
+		void addReference()           { unsigned n = increment(); assert(n != 0); (void)n; }
 		//! removeReference delete the object when refCount is zero		
-		void removeReference()		  { if (--refCount == 0) delete this; }
+		void removeReference()		  { if (decrement() == 0) delete this; }
+
+		/*! \brief sets the concurrent mode
+			In concurrent mode, the reference counts are updated atomically. It must be set
+			before sharing objects between threads, and reset only once the threads are joined.
+		*/
+		static void concurrent (bool state);
 		
 	protected:
 		smartable() : refCount(0) {}
@@ -70,6 +100,11 @@ template<class T> class SMARTP {
 		SMARTP(const SMARTP<T2>& ptr) : fSmartPtr((T*)ptr) { if (fSmartPtr) fSmartPtr->addReference(); }
 		//! build a smart pointer from another smart pointer reference
 		SMARTP(const SMARTP& ptr) : fSmartPtr((T*)ptr)     { if (fSmartPtr) fSmartPtr->addReference(); }
+		//! move constructor: takes the reference of the source, which is left empty
+		SMARTP(SMARTP&& ptr) noexcept : fSmartPtr(ptr.fSmartPtr)	{ ptr.fSmartPtr = 0; }
+		//! move constructor from a convertible class smart pointer
+		template<class T2> 
+		SMARTP(SMARTP<T2>&& ptr) noexcept : fSmartPtr(ptr.release())	{}
 
 		//! the smart pointer destructor: simply removes one reference count
 		~SMARTP()  { if (fSmartPtr) fSmartPtr->removeReference(); }
@@ -110,14 +145,32 @@ template<class T> class SMARTP {
 		}
 		//! operator = to support inherited class reference
 		SMARTP& operator=(const SMARTP<T>& p_)                { return operator=((T *) p_); }
+		//! move assignment: takes the reference of the source, which is left empty
+		SMARTP& operator=(SMARTP<T>&& p_) noexcept {
+			if (this != &p_) {
+				T* old = fSmartPtr;
+				fSmartPtr = p_.fSmartPtr;
+				p_.fSmartPtr = 0;
+				if (old) old->removeReference();
+			}
+			return *this;
+		}
+		//! exchanges the pointers, without reference count change
+		void swap (SMARTP<T>& p_) noexcept		{ std::swap (fSmartPtr, p_.fSmartPtr); }
+		/*! \brief gives up the pointer without reference count change
+			\return the pointer, the caller is in charge of its reference
+		*/
+		T* release () noexcept	{ T* p = fSmartPtr; fSmartPtr = 0; return p; }
 		//! dynamic cast support
 		template<class T2> SMARTP& cast(T2* p_)               { return operator=(dynamic_cast<T*>(p_)); }
 		//! dynamic cast support
 		template<class T2> SMARTP& cast(const SMARTP<T2>& p_) { return operator=(dynamic_cast<T*>(p_)); }
-		//! operator < (require by VC6 for maps)
-		bool operator < (const SMARTP<T>& p_) const			  { return (void*)this < (void*)p_; }
+		//! operator < (require by VC6 for maps): compares the pointed objects addresses
+		bool operator < (const SMARTP<T>& p_) const			  { return fSmartPtr < p_.fSmartPtr; }
 };
 
+template<class T> inline void swap (SMARTP<T>& a, SMARTP<T>& b) noexcept	{ a.swap (b); }
+
 }
 
 #endif
@@ -0,0 +1,249 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "xmlescape.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+// the special characters search, 8 bytes at a time: a byte of w equal to the byte
+// of c gives a null byte in w ^ c, which is detected using the borrow of the
+// subtraction (see 'Bit Twiddling Hacks', determine if a word has a zero byte)
+static const uint64_t kOnes  = 0x0101010101010101ULL;
+static const uint64_t kHighs = 0x8080808080808080ULL;
+
+static inline uint64_t hasByte (uint64_t w, unsigned char c)
+{
+	uint64_t v = w ^ (kOnes * c);
+	return (v - kOnes) & ~v & kHighs;
+}
+
+// a byte of w lower than n (n <= 128) gives a borrow as well
+static inline uint64_t hasLess (uint64_t w, unsigned char n)
+{
+	return (w - kOnes * n) & ~w & kHighs;
+}
+
+// the carriage return is always written as a character reference since it would
+// be normalized by a conforming parser, the tab and the line feed as well in attributes
+static inline bool special (char c, bool attribute)
+{
+	switch (c) {
+		case '&': case '<': case '>': case '\r':
+			return true;
+		case '"': case '\'': case '\t': case '\n':
+			return attribute;
+	}
+	return false;
+}
+
+//______________________________________________________________________________
+size_t xmlescape::find (const char* text, size_t size, bool attribute)
+{
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t w;
+		memcpy (&w, text + i, 8);
+		// '<' and '>' only differ by the bit 1
+		uint64_t found = hasByte (w, '&') | hasByte (w | (kOnes * 2), '>');
+		// the tab, line feed and carriage return are the only special bytes lower than 14
+		if (attribute) found |= hasByte (w, '"') | hasByte (w, '\'') | hasLess (w, 14);
+		else found |= hasByte (w, '\r');
+		if (found) break;
+	}
+	for (; i < size; i++)
+		if (special (text[i], attribute)) return i;
+	return size;
+}
+
+//______________________________________________________________________________
+void xmlescape::append (string& out, const char* text, size_t size, bool attribute)
+{
+	const char* end = text + size;
+	for (;;) {
+		size_t n = find (text, end - text, attribute);
+		out.append (text, n);
+		text += n;
+		if (text == end) break;
+		switch (*text++) {
+			case '&':	out.append ("&amp;", 5); break;
+			case '<':	out.append ("&lt;", 4); break;
+			case '>':	out.append ("&gt;", 4); break;
+			case '"':	out.append ("&quot;", 6); break;
+			case '\'':	out.append ("&apos;", 6); break;
+			case '\t':	out.append ("&#x9;", 5); break;
+			case '\n':	out.append ("&#xa;", 5); break;
+			case '\r':	out.append ("&#xd;", 5); break;
+		}
+	}
+}
+
+//______________________________________________________________________________
+static void utf8 (string& out, unsigned long c)
+{
+	if (c < 0x80) out.push_back (char(c));
+	else if (c < 0x800) {
+		out.push_back (char(0xc0 | (c >> 6)));
+		out.push_back (char(0x80 | (c & 0x3f)));
+	}
+	else if (c < 0x10000) {
+		out.push_back (char(0xe0 | (c >> 12)));
+		out.push_back (char(0x80 | ((c >> 6) & 0x3f)));
+		out.push_back (char(0x80 | (c & 0x3f)));
+	}
+	else {
+		out.push_back (char(0xf0 | (c >> 18)));
+		out.push_back (char(0x80 | ((c >> 12) & 0x3f)));
+		out.push_back (char(0x80 | ((c >> 6) & 0x3f)));
+		out.push_back (char(0x80 | (c & 0x3f)));
+	}
+}
+
+//______________________________________________________________________________
+// the ISO Latin 1 and Latin 2 entities declared by the MusicXML DTD (isolat1.ent
+// and isolat2.ent), sorted by name
+struct namedEntity { const char* name; unsigned long code; };
+static const namedEntity kIsoLatin[] = {
+	{ "AElig", 0xc6 }, { "Aacute", 0xc1 }, { "Abreve", 0x102 }, { "Acirc", 0xc2 },
+	{ "Agrave", 0xc0 }, { "Amacr", 0x100 }, { "Aogon", 0x104 }, { "Aring", 0xc5 },
+	{ "Atilde", 0xc3 }, { "Auml", 0xc4 }, { "Cacute", 0x106 }, { "Ccaron", 0x10c },
+	{ "Ccedil", 0xc7 }, { "Ccirc", 0x108 }, { "Cdot", 0x10a }, { "Dcaron", 0x10e },
+	{ "Dstrok", 0x110 }, { "ENG", 0x14a }, { "ETH", 0xd0 }, { "Eacute", 0xc9 },
+	{ "Ecaron", 0x11a }, { "Ecirc", 0xca }, { "Edot", 0x116 }, { "Egrave", 0xc8 },
+	{ "Emacr", 0x112 }, { "Eogon", 0x118 }, { "Euml", 0xcb }, { "Gbreve", 0x11e },
+	{ "Gcedil", 0x122 }, { "Gcirc", 0x11c }, { "Gdot", 0x120 }, { "Hcirc", 0x124 },
+	{ "Hstrok", 0x126 }, { "IJlig", 0x132 }, { "Iacute", 0xcd }, { "Icirc", 0xce },
+	{ "Idot", 0x130 }, { "Igrave", 0xcc }, { "Imacr", 0x12a }, { "Iogon", 0x12e },
+	{ "Itilde", 0x128 }, { "Iuml", 0xcf }, { "Jcirc", 0x134 }, { "Kcedil", 0x136 },
+	{ "Lacute", 0x139 }, { "Lcaron", 0x13d }, { "Lcedil", 0x13b }, { "Lmidot", 0x13f },
+	{ "Lstrok", 0x141 }, { "Nacute", 0x143 }, { "Ncaron", 0x147 }, { "Ncedil", 0x145 },
+	{ "Ntilde", 0xd1 }, { "OElig", 0x152 }, { "Oacute", 0xd3 }, { "Ocirc", 0xd4 },
+	{ "Odblac", 0x150 }, { "Ograve", 0xd2 }, { "Omacr", 0x14c }, { "Oslash", 0xd8 },
+	{ "Otilde", 0xd5 }, { "Ouml", 0xd6 }, { "Racute", 0x154 }, { "Rcaron", 0x158 },
+	{ "Rcedil", 0x156 }, { "Sacute", 0x15a }, { "Scaron", 0x160 }, { "Scedil", 0x15e },
+	{ "Scirc", 0x15c }, { "THORN", 0xde }, { "Tcaron", 0x164 }, { "Tcedil", 0x162 },
+	{ "Tstrok", 0x166 }, { "Uacute", 0xda }, { "Ubreve", 0x16c }, { "Ucirc", 0xdb },
+	{ "Udblac", 0x170 }, { "Ugrave", 0xd9 }, { "Umacr", 0x16a }, { "Uogon", 0x172 },
+	{ "Uring", 0x16e }, { "Utilde", 0x168 }, { "Uuml", 0xdc }, { "Wcirc", 0x174 },
+	{ "Yacute", 0xdd }, { "Ycirc", 0x176 }, { "Yuml", 0x178 }, { "Zacute", 0x179 },
+	{ "Zcaron", 0x17d }, { "Zdot", 0x17b }, { "aacute", 0xe1 }, { "abreve", 0x103 },
+	{ "acirc", 0xe2 }, { "aelig", 0xe6 }, { "agrave", 0xe0 }, { "amacr", 0x101 },
+	{ "aogon", 0x105 }, { "aring", 0xe5 }, { "atilde", 0xe3 }, { "auml", 0xe4 },
+	{ "cacute", 0x107 }, { "ccaron", 0x10d }, { "ccedil", 0xe7 }, { "ccirc", 0x109 },
+	{ "cdot", 0x10b }, { "dcaron", 0x10f }, { "dstrok", 0x111 }, { "eacute", 0xe9 },
+	{ "ecaron", 0x11b }, { "ecirc", 0xea }, { "edot", 0x117 }, { "egrave", 0xe8 },
+	{ "emacr", 0x113 }, { "eng", 0x14b }, { "eogon", 0x119 }, { "eth", 0xf0 },
+	{ "euml", 0xeb }, { "gacute", 0x1f5 }, { "gbreve", 0x11f }, { "gcirc", 0x11d },
+	{ "gdot", 0x121 }, { "hcirc", 0x125 }, { "hstrok", 0x127 }, { "iacute", 0xed },
+	{ "icirc", 0xee }, { "igrave", 0xec }, { "ijlig", 0x133 }, { "imacr", 0x12b },
+	{ "inodot", 0x131 }, { "iogon", 0x12f }, { "itilde", 0x129 }, { "iuml", 0xef },
+	{ "jcirc", 0x135 }, { "kcedil", 0x137 }, { "kgreen", 0x138 }, { "lacute", 0x13a },
+	{ "lcaron", 0x13e }, { "lcedil", 0x13c }, { "lmidot", 0x140 }, { "lstrok", 0x142 },
+	{ "nacute", 0x144 }, { "napos", 0x149 }, { "ncaron", 0x148 }, { "ncedil", 0x146 },
+	{ "ntilde", 0xf1 }, { "oacute", 0xf3 }, { "ocirc", 0xf4 }, { "odblac", 0x151 },
+	{ "oelig", 0x153 }, { "ograve", 0xf2 }, { "omacr", 0x14d }, { "oslash", 0xf8 },
+	{ "otilde", 0xf5 }, { "ouml", 0xf6 }, { "racute", 0x155 }, { "rcaron", 0x159 },
+	{ "rcedil", 0x157 }, { "sacute", 0x15b }, { "scaron", 0x161 }, { "scedil", 0x15f },
+	{ "scirc", 0x15d }, { "szlig", 0xdf }, { "tcaron", 0x165 }, { "tcedil", 0x163 },
+	{ "thorn", 0xfe }, { "tstrok", 0x167 }, { "uacute", 0xfa }, { "ubreve", 0x16d },
+	{ "ucirc", 0xfb }, { "udblac", 0x171 }, { "ugrave", 0xf9 }, { "umacr", 0x16b },
+	{ "uogon", 0x173 }, { "uring", 0x16f }, { "utilde", 0x169 }, { "uuml", 0xfc },
+	{ "wcirc", 0x175 }, { "yacute", 0xfd }, { "ycirc", 0x177 }, { "yuml", 0xff },
+	{ "zacute", 0x17a }, { "zcaron", 0x17e }, { "zdot", 0x17c }
+};
+
+static bool isoLatin (const char* name, size_t size, string& out)
+{
+	size_t lo = 0, hi = sizeof(kIsoLatin) / sizeof(kIsoLatin[0]);
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		const char* e = kIsoLatin[mid].name;
+		int cmp = strncmp (e, name, size);
+		if (!cmp && e[size]) cmp = 1;		// e is longer than name
+		if (!cmp) {
+			utf8 (out, kIsoLatin[mid].code);
+			return true;
+		}
+		if (cmp < 0) lo = mid + 1;
+		else hi = mid;
+	}
+	return false;
+}
+
+// decodes the entity or the character reference between & and ;
+static bool entity (const char* name, size_t size, string& out)
+{
+	if ((size > 1) && (name[0] == '#')) {
+		bool hex = (name[1] == 'x');
+		const char* digits = name + (hex ? 2 : 1);
+		if (hex ? !isxdigit ((unsigned char)*digits) : !isdigit ((unsigned char)*digits)) return false;
+		char* end;
+		unsigned long c = strtoul (digits, &end, hex ? 16 : 10);
+		if ((end != name + size) || (end == digits) || !c || (c > 0x10ffff)) return false;
+		utf8 (out, c);
+		return true;
+	}
+	switch (size) {
+		case 2:
+			if (!strncmp (name, "lt", 2))		{ out.push_back ('<'); return true; }
+			if (!strncmp (name, "gt", 2))		{ out.push_back ('>'); return true; }
+			break;
+		case 3:
+			if (!strncmp (name, "amp", 3))		{ out.push_back ('&'); return true; }
+			break;
+		case 4:
+			if (!strncmp (name, "quot", 4))		{ out.push_back ('"'); return true; }
+			if (!strncmp (name, "apos", 4))		{ out.push_back ('\''); return true; }
+			break;
+	}
+	return isoLatin (name, size, out);
+}
+
+//______________________________________________________________________________
+bool xmlescape::decode (const char* text, string& out)
+{
+	const char* next = strpbrk (text, "&\r");
+	if (!next) return false;
+
+	out.clear();
+	while (next) {
+		out.append (text, next - text);
+		if (*next == '\r') {			// line ends normalization: \r\n and \r give \n
+			out.push_back ('\n');
+			text = next + ((next[1] == '\n') ? 2 : 1);
+		}
+		else {
+			const char* name = next + 1;
+			const char* semicolon = name;
+			while (*semicolon && (*semicolon != ';') && (*semicolon != '&') && (semicolon - name < 10)) semicolon++;
+			if ((*semicolon == ';') && entity (name, semicolon - name, out))
+				text = semicolon + 1;
+			else {
+				out.push_back ('&');		// kept as is
+				text = name;
+			}
+		}
+		next = strpbrk (text, "&\r");
+	}
+	out.append (text);
+	return true;
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __xmlescape__
+#define __xmlescape__
+
+#include <string>
+#include "exports.h"
+
+namespace MusicXML2
+{
+
+/*!
+\brief the xml special characters escaping and the entities decoding.
+
+	The elements values and the attributes values are stored as plain text: the
+	entities and the characters references are decoded when reading and the special
+	characters are escaped when writing. The special characters are & < > and the
+	carriage return, the quotes, the tab and the line feed are escaped as well in
+	attributes: the parser doesn't accept any quote in an attribute value and the
+	white spaces would be normalized by a conforming parser.
+	The decoded entities are the predefined ones and the ISO Latin 1 and 2 entities
+	declared by the MusicXML DTD. Other entities are kept as text and thus written
+	back escaped: "&name;" gives "&amp;name;". The line ends are normalized when
+	decoding, a carriage return in a decoded text thus comes from a character reference.
+
+	The search for the special characters reads the text a word at a time: the
+	escaping is only made when a special character is found.
+*/
+class EXP xmlescape {
+	public:
+		//! gives the index of the first special character of \c text, \c size when there is none
+		static size_t	find (const char* text, size_t size, bool attribute);
+		//! appends \c text to \c out, escaping the special characters
+		static void		append (std::string& out, const char* text, size_t size, bool attribute);
+		/*! \brief decodes the predefined and the DTD entities and the characters references
+			and normalizes the line ends. Unknown entities and malformed references are kept as is.
+			\return false when \c text has nothing to decode, \c out is then left unchanged
+		*/
+		static bool		decode (const char* text, std::string& out);
+};
+
+}
+
+#endif
@@ -29,34 +29,42 @@ int		libmxmlwrap();
 bool	readfile   (const char * file, reader * r);
 bool	readstream (FILE * file, reader * r);
 bool	readbuffer (const char * buffer, reader * r);
+bool	readmemory (char * buffer, size_t size, reader * r);
 #ifdef __cplusplus
 }
 #endif
 
-int   yylex (void);
-extern char * libmxmltext;
-extern int libmxmllineno;
-extern FILE * libmxmlin;
+extern thread_local char * libmxmltext;
+extern thread_local int libmxmllineno;
+extern thread_local FILE * libmxmlin;
 
 #define YYERROR_VERBOSE
 #define ERROR(str)	{ yyerror(str); YYABORT; }
 #define MAXLEN	1024
 #define VLEN	256
-char attributeName[MAXLEN];
-char attributeVal[MAXLEN];
 
-char xmlversion[VLEN];
-char xmlencoding[MAXLEN];
-int xmlStandalone = -1;
+// the parser state is thread local: distinct threads can parse concurrently
+// but the parse calls can't be nested on a thread (e.g. a reader reading another
+// file from its callbacks): a nested call is detected and fails
+thread_local char attributeName[MAXLEN];
+thread_local char attributeVal[MAXLEN];
 
-char eltName[MAXLEN];
-char doctypeStart[MAXLEN];
-char doctypePub[MAXLEN];
-char doctypeSys[MAXLEN];
+thread_local char xmlversion[VLEN];
+thread_local char xmlencoding[MAXLEN];
+thread_local int xmlStandalone = -1;
 
-reader * gReader;
+thread_local char eltName[MAXLEN];
+thread_local char doctypeStart[MAXLEN];
+thread_local char doctypePub[MAXLEN];
+thread_local char doctypeSys[MAXLEN];
 
-static void init (reader * r) {
+thread_local reader * gReader;		// the current reader, null when no parse is in progress
+
+static bool init (reader * r) {
+	if (gReader) {
+		r->error ("nested parse: the parser is already in use by the current thread", 0);
+		return false;
+	}
 	gReader = r;
 	xmlStandalone = -1;
 	eltName[0]		= 0;
@@ -67,6 +75,13 @@ static void init (reader * r) {
 	doctypeStart[0]	= 0;
 	doctypePub[0]	= 0;
 	doctypeSys[0]	= 0;
+	return true;
+}
+
+// releases the scanner buffers, resets the scanner state and ends the parse
+static void done () {
+	lexend();
+	gReader = 0;
 }
 
 static char * unquote (char * text) {
@@ -88,6 +103,7 @@ int		libmxmlwrap()		{ return(1); }
 
 
 %start document
+%define api.pure full
 
 %token XMLDECL VERSION ENCODING STANDALONE YES NO ENDXMLDECL
 %token DOCTYPE PUBLIC SYSTEM COMMENT PI
@@ -155,7 +171,7 @@ decl		: /* empty */
 
 versiondec	: SPACE VERSION EQ QUOTEDSTR 		{ store(xmlversion, unquote(libmxmltext)); }
 encodingdec	: SPACE ENCODING EQ QUOTEDSTR 		{ store(xmlencoding, unquote(libmxmltext)); }
-stdalonedec	: SPACE STANDALONE EQ bool  		{ xmlStandalone = yylval; }
+stdalonedec	: SPACE STANDALONE EQ bool  		{ xmlStandalone = $4; }
 bool		: YES | NO ;
 
 doctype		: DOCTYPE SPACE startname SPACE id GT;
@@ -172,22 +188,42 @@ misc		: /* empty */
 
 %%
 
-#define yy_delete_buffer	libmxml_delete_buffer
 #define yy_scan_string		libmxml_scan_string
+#define yy_scan_buffer		libmxml_scan_buffer
+
+// ends the parse on every exit path, including when a reader callback throws
+// (the file, if any, is closed as well)
+class parseguard {
+	FILE *	fFile;
+	public:
+				 parseguard (FILE * fd = 0) : fFile(fd) {}
+				~parseguard () { if (fFile) fclose (fFile); done(); }
+};
 
 bool readbuffer (const char * buffer, reader * r) 
 {
 	if (!buffer) return false;		// error for empty buffers
 
-	init(r);
-	YY_BUFFER_STATE b;
+	if (!init(r)) return false;
+	parseguard guard;
     // Copy string into new buffer and Switch buffers
-    b = yy_scan_string (buffer);
-    // Parse the string
+    yy_scan_string (buffer);
+    // Parse the string; the guard releases the scanner buffers and resets the scanner state
+	int ret = yyparse();
+ 	return ret==0;
+}
+
+// parses the buffer in place, without copy
+// the buffer is modified during the parsing but restored at the end
+// it must be terminated by 2 null chars, which are included in size
+bool readmemory (char * buffer, size_t size, reader * r) 
+{
+	if (!buffer || (size < 2)) return false;
+
+	if (!init(r)) return false;
+	parseguard guard;
+	if (!yy_scan_buffer (buffer, size)) return false;
 	int ret = yyparse();
-    // Delete the new buffer
-	yy_delete_buffer(b);
-	BEGIN(INITIAL);
  	return ret==0;
 }
 
@@ -198,23 +234,23 @@ bool readfile (const char * file, reader * r)
 		cerr << "can't open file " << file << endl;
 		return false;
 	}
-	init(r);
-	libmxmlrestart(fd);
-	libmxmlin = fd;
+	if (!init(r)) {
+		fclose (fd);
+		return false;
+	}
+	parseguard guard (fd);
+	lexinit(fd);
  	int ret = yyparse();
- 	fclose (fd);
-	BEGIN(INITIAL);
  	return ret==0;
 }
 
 bool readstream (FILE * fd, reader * r) 
 {
 	if (!fd) return false;
-	init(r);
-	libmxmlrestart(fd);
-	libmxmlin = fd;
+	if (!init(r)) return false;
+	parseguard guard;
+	lexinit(fd);
  	int ret = yyparse();
-	BEGIN(INITIAL);
  	return ret==0;
 }
 
@@ -178,9 +178,9 @@ typedef struct yy_buffer_state *YY_BUFFER_STATE;
 typedef size_t yy_size_t;
 #endif
 
-extern yy_size_t libmxmlleng;
+extern thread_local yy_size_t libmxmlleng;
 
-extern FILE *libmxmlin, *libmxmlout;
+extern thread_local FILE *libmxmlin, *libmxmlout;
 
 #define EOB_ACT_CONTINUE_SCAN 0
 #define EOB_ACT_END_OF_FILE 1
@@ -283,9 +283,9 @@ struct yy_buffer_state
 #endif /* !YY_STRUCT_YY_BUFFER_STATE */
 
 /* Stack of input buffers. */
-static size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
-static size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
-static YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
+static thread_local size_t yy_buffer_stack_top = 0; /**< index of top of stack. */
+static thread_local size_t yy_buffer_stack_max = 0; /**< capacity of stack. */
+static thread_local YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
 
 /* We provide macros for accessing buffer states in case in the
  * future we want to put the buffer states in a more general
@@ -303,19 +303,19 @@ static YY_BUFFER_STATE * yy_buffer_stack = 0; /**< Stack as an array. */
 #define YY_CURRENT_BUFFER_LVALUE (yy_buffer_stack)[(yy_buffer_stack_top)]
 
 /* yy_hold_char holds the character lost when libmxmltext is formed. */
-static char yy_hold_char;
-static yy_size_t yy_n_chars;		/* number of characters read into yy_ch_buf */
-yy_size_t libmxmlleng;
+static thread_local char yy_hold_char;
+static thread_local yy_size_t yy_n_chars;		/* number of characters read into yy_ch_buf */
+thread_local yy_size_t libmxmlleng;
 
 /* Points to current character in buffer. */
-static char *yy_c_buf_p = (char *) 0;
-static int yy_init = 0;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
+static thread_local char *yy_c_buf_p = (char *) 0;
+static thread_local int yy_init = 0;		/* whether we need to initialize */
+static thread_local int yy_start = 0;	/* start state number */
 
 /* Flag which is used to allow libmxmlwrap()'s to do buffer switches
  * instead of setting up a fresh libmxmlin.  A bit of a hack ...
  */
-static int yy_did_buffer_switch_on_eof;
+static thread_local int yy_did_buffer_switch_on_eof;
 
 void libmxmlrestart (FILE *input_file  );
 void libmxml_switch_to_buffer (YY_BUFFER_STATE new_buffer  );
@@ -365,15 +365,15 @@ void libmxmlfree (void *  );
 
 typedef unsigned char YY_CHAR;
 
-FILE *libmxmlin = (FILE *) 0, *libmxmlout = (FILE *) 0;
+thread_local FILE *libmxmlin = (FILE *) 0, *libmxmlout = (FILE *) 0;
 
 typedef int yy_state_type;
 
-extern int libmxmllineno;
+extern thread_local int libmxmllineno;
 
-int libmxmllineno = 1;
+thread_local int libmxmllineno = 1;
 
-extern char *libmxmltext;
+extern thread_local char *libmxmltext;
 #define yytext_ptr libmxmltext
 
 static yy_state_type yy_get_previous_state (void );
@@ -435,7 +435,7 @@ static yyconst flex_int32_t yy_ec[256] =
         1,    1,    1,    1,    1,    1,    1,    1,    2,    3,
         1,    1,    4,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    2,    5,    6,    1,    1,    1,    7,    6,    1,
+        1,    2,    5,    6,    1,    1,    1,    1,    6,    1,
         1,    1,    1,    1,    8,    9,   10,    9,    9,    9,
         9,    9,    9,    9,    9,    9,    9,    9,    1,   11,
        12,   13,   14,    1,   15,   16,   17,   18,   19,   15,
@@ -739,11 +739,11 @@ static yyconst flex_int32_t yy_rule_can_match_eol[28] =
 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1, 0, 0, 1, 0, 1, 
     0, 1, 1, 0, 1, 0, 0, 0,     };
 
-static yy_state_type yy_last_accepting_state;
-static char *yy_last_accepting_cpos;
+static thread_local yy_state_type yy_last_accepting_state;
+static thread_local char *yy_last_accepting_cpos;
 
-extern int libmxml_flex_debug;
-int libmxml_flex_debug = 0;
+extern thread_local int libmxml_flex_debug;
+thread_local int libmxml_flex_debug = 0;
 
 /* The intent behind this definition is that it'll catch
  * any uses of REJECT which flex missed.
@@ -752,7 +752,7 @@ int libmxml_flex_debug = 0;
 #define yymore() yymore_used_but_not_detected
 #define YY_MORE_ADJ 0
 #define YY_RESTORE_YY_MORE_OFFSET
-char *libmxmltext;
+thread_local char *libmxmltext;
 #line 1 "xml.l"
 #line 2 "xml.l"
  
@@ -770,11 +770,12 @@ char *libmxmltext;
 
 #define YY_NO_UNISTD_H
 
-extern int libmxmllval;
+// the parser is pure: semantic values are passed to the scanner by the parser
+#define YY_DECL int libmxmllex (YYSTYPE * lvalp)
 
-static int utf16 = 0;
-static int bigendian = 1;
-static int start = 1;
+static thread_local int utf16 = 0;
+static thread_local int bigendian = 1;
+static thread_local int start = 1;
 
 static int wgetc(FILE * fd) {
 	int c = getc(fd);
@@ -812,13 +813,14 @@ void lexinit(FILE* fd) {
 	utf16 = 0;
 	bigendian = 1;
 	start = 1;
-	libmxmlrestart(fd);
+	yyrestart(fd);
+	libmxmlin = fd;
 }
 		 
+// releases the current thread scanner buffers and resets its state (including the line number)
+int libmxmllex_destroy (void);
 void lexend() {
-	if (YY_CURRENT_BUFFER) {
-		libmxml_delete_buffer (YY_CURRENT_BUFFER);
-	}
+	libmxmllex_destroy();
 }
 
 #define getc	wgetc
@@ -826,7 +828,7 @@ void lexend() {
 #define register		// to get rid of the -Wdeprecated-register
 
 
-#line 830 "xmllex.c++"
+#line 832 "xmllex.c++"
 
 #define INITIAL 0
 #define COMMENTSECT 1
@@ -1011,11 +1013,11 @@ YY_DECL
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
     
-#line 92 "xml.l"
+#line 94 "xml.l"
 
 
 
-#line 1019 "xmllex.c++"
+#line 1021 "xmllex.c++"
 
 	if ( !(yy_init) )
 		{
@@ -1107,142 +1109,142 @@ do_action:	/* This label is used only to access EOF actions. */
 case 1:
 /* rule 1 can match eol */
 YY_RULE_SETUP
-#line 95 "xml.l"
+#line 97 "xml.l"
 { BEGIN COMMENTSECT; }
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 96 "xml.l"
+#line 98 "xml.l"
 { BEGIN 0; }
 	YY_BREAK
 case 3:
 /* rule 3 can match eol */
 YY_RULE_SETUP
-#line 97 "xml.l"
+#line 99 "xml.l"
 { return COMMENT; }
 	YY_BREAK
 case 4:
 /* rule 4 can match eol */
 YY_RULE_SETUP
-#line 100 "xml.l"
+#line 102 "xml.l"
 { BEGIN XMLSECT; return XMLDECL; }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 101 "xml.l"
+#line 103 "xml.l"
 { BEGIN 0; return ENDXMLDECL; }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 102 "xml.l"
+#line 104 "xml.l"
 { return VERSION; }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 103 "xml.l"
+#line 105 "xml.l"
 { return ENCODING; }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 104 "xml.l"
+#line 106 "xml.l"
 { return STANDALONE; }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 105 "xml.l"
-{ libmxmllval=1; return YES; }
+#line 107 "xml.l"
+{ *lvalp=1; return YES; }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 106 "xml.l"
-{ libmxmllval=0; return NO; }
+#line 108 "xml.l"
+{ *lvalp=0; return NO; }
 	YY_BREAK
 case 11:
 /* rule 11 can match eol */
 YY_RULE_SETUP
-#line 108 "xml.l"
+#line 110 "xml.l"
 { BEGIN PISECT; }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 109 "xml.l"
+#line 111 "xml.l"
 { BEGIN 0; return PI; }
 	YY_BREAK
 case 13:
 /* rule 13 can match eol */
 YY_RULE_SETUP
-#line 110 "xml.l"
+#line 112 "xml.l"
 { return PI; }
 	YY_BREAK
 case 14:
 /* rule 14 can match eol */
 YY_RULE_SETUP
-#line 112 "xml.l"
+#line 114 "xml.l"
 { BEGIN DOCTYPESECT; return DOCTYPE; }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 113 "xml.l"
+#line 115 "xml.l"
 { return PUBLIC; }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 114 "xml.l"
+#line 116 "xml.l"
 { return SYSTEM; }
 	YY_BREAK
 case 17:
 /* rule 17 can match eol */
 YY_RULE_SETUP
-#line 116 "xml.l"
+#line 118 "xml.l"
 { BEGIN 0; return LT; }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 117 "xml.l"
+#line 119 "xml.l"
 { BEGIN DATASECT; return GT; }
 	YY_BREAK
 case 19:
 /* rule 19 can match eol */
 YY_RULE_SETUP
-#line 118 "xml.l"
+#line 120 "xml.l"
 { BEGIN 0; return ENDXMLS; }
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 119 "xml.l"
+#line 121 "xml.l"
 { return ENDXMLE; }
 	YY_BREAK
 case 21:
 /* rule 21 can match eol */
 YY_RULE_SETUP
-#line 121 "xml.l"
+#line 123 "xml.l"
 { return SPACE; }
 	YY_BREAK
 case 22:
 /* rule 22 can match eol */
 YY_RULE_SETUP
-#line 122 "xml.l"
+#line 124 "xml.l"
 { return DATA; }
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
-#line 123 "xml.l"
+#line 125 "xml.l"
 { return NAME; }
 	YY_BREAK
 case 24:
 /* rule 24 can match eol */
 YY_RULE_SETUP
-#line 124 "xml.l"
+#line 126 "xml.l"
 { return QUOTEDSTR; }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 125 "xml.l"
+#line 127 "xml.l"
 { return EQ; }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 127 "xml.l"
+#line 129 "xml.l"
 { /* extra space ignored*/ }
 	YY_BREAK
 case YY_STATE_EOF(INITIAL):
@@ -1251,15 +1253,15 @@ case YY_STATE_EOF(DATASECT):
 case YY_STATE_EOF(XMLSECT):
 case YY_STATE_EOF(PISECT):
 case YY_STATE_EOF(DOCTYPESECT):
-#line 129 "xml.l"
+#line 131 "xml.l"
 yyterminate();
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
-#line 130 "xml.l"
+#line 132 "xml.l"
 ECHO;
 	YY_BREAK
-#line 1263 "xmllex.c++"
+#line 1265 "xmllex.c++"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -2222,4 +2224,4 @@ void libmxmlfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 130 "xml.l"
+#line 132 "xml.l"
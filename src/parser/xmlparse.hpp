@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
+/* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,67 +31,65 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Tokens.  */
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_LIBMXML_XMLPARSE_HPP_INCLUDED
+# define YY_LIBMXML_XMLPARSE_HPP_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int libmxmldebug;
+#endif
+
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     XMLDECL = 258,
-     VERSION = 259,
-     ENCODING = 260,
-     STANDALONE = 261,
-     YES = 262,
-     NO = 263,
-     ENDXMLDECL = 264,
-     DOCTYPE = 265,
-     PUBLIC = 266,
-     SYSTEM = 267,
-     COMMENT = 268,
-     PI = 269,
-     NAME = 270,
-     DATA = 271,
-     QUOTEDSTR = 272,
-     SPACE = 273,
-     LT = 274,
-     GT = 275,
-     ENDXMLS = 276,
-     ENDXMLE = 277,
-     EQ = 278
-   };
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    XMLDECL = 258,                 /* XMLDECL  */
+    VERSION = 259,                 /* VERSION  */
+    ENCODING = 260,                /* ENCODING  */
+    STANDALONE = 261,              /* STANDALONE  */
+    YES = 262,                     /* YES  */
+    NO = 263,                      /* NO  */
+    ENDXMLDECL = 264,              /* ENDXMLDECL  */
+    DOCTYPE = 265,                 /* DOCTYPE  */
+    PUBLIC = 266,                  /* PUBLIC  */
+    SYSTEM = 267,                  /* SYSTEM  */
+    COMMENT = 268,                 /* COMMENT  */
+    PI = 269,                      /* PI  */
+    NAME = 270,                    /* NAME  */
+    DATA = 271,                    /* DATA  */
+    QUOTEDSTR = 272,               /* QUOTEDSTR  */
+    SPACE = 273,                   /* SPACE  */
+    LT = 274,                      /* LT  */
+    GT = 275,                      /* GT  */
+    ENDXMLS = 276,                 /* ENDXMLS  */
+    ENDXMLE = 277,                 /* ENDXMLE  */
+    EQ = 278                       /* EQ  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
-/* Tokens.  */
-#define XMLDECL 258
-#define VERSION 259
-#define ENCODING 260
-#define STANDALONE 261
-#define YES 262
-#define NO 263
-#define ENDXMLDECL 264
-#define DOCTYPE 265
-#define PUBLIC 266
-#define SYSTEM 267
-#define COMMENT 268
-#define PI 269
-#define NAME 270
-#define DATA 271
-#define QUOTEDSTR 272
-#define SPACE 273
-#define LT 274
-#define GT 275
-#define ENDXMLS 276
-#define ENDXMLE 277
-#define EQ 278
-
-
-
 
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 typedef int YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
 # define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
-extern YYSTYPE libmxmllval;
 
+
+
+int libmxmlparse (void);
+
+
+#endif /* !YY_LIBMXML_XMLPARSE_HPP_INCLUDED  */
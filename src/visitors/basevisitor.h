@@ -18,13 +18,55 @@
 #pragma warning (disable : 4251 4275)
 #endif
 
+#include <cstddef>
+#include <typeinfo>
+#include <vector>
+
 namespace MusicXML2 
 {
 
+/*!
+\brief the base class of the visitors.
+
+	It maintains a dispatch table giving the visitor interfaces (e.g. visitor<S_note>)
+	of the visitor, indexed by musicxml element type: the cross casts are computed once
+	per visitor and per element type. The table is rebuilt when the visitor dynamic type
+	changes (e.g. after the visitor construction), it is not copied with the visitor.
+*/
 class basevisitor 
 {
+	const std::type_info*	fDispatchType;	// the visitor type the dispatch table has been built for
+	std::vector<void*>		fDispatch;		// the visitor interfaces (or null) indexed by element type
+
+	// marks the not yet computed entries: a constant value, not a static object address,
+	// so that it is the same in every module using the header
+	static void*	unknown ()		{ return reinterpret_cast<void*>(1); }
+
 	public:
+				 basevisitor() : fDispatchType(0) {}
+				 basevisitor(const basevisitor&) : fDispatchType(0) {}
 		virtual ~basevisitor() {}
+		basevisitor& operator= (const basevisitor&)		{ return *this; }
+
+		/*! \brief gives the visitor interface V for a musicxml element type
+			\param type the element type
+			\return the visitor interface or null when the visitor doesn't implement V
+		*/
+		template <typename V> V* getVisitor (int type) {
+			const std::type_info* t = &typeid(*this);
+			if (t != fDispatchType) {
+				fDispatch.clear();
+				fDispatchType = t;
+			}
+			if (size_t(type) >= fDispatch.size()) fDispatch.resize (type + 1, unknown());
+			void* v = fDispatch[type];
+			if (v == unknown()) {
+				V* i = dynamic_cast<V*>(this);
+				fDispatch[type] = i;
+				return i;
+			}
+			return static_cast<V*>(v);
+		}
 };
 
 }
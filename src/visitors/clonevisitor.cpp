@@ -25,14 +25,10 @@ namespace MusicXML2
 //______________________________________________________________________________
 void clonevisitor::copyAttributes (const Sxmlelement& src, Sxmlelement& dst )
 {
-	vector<Sxmlattribute> attr = src->attributes();
-	vector<Sxmlattribute>::const_iterator iter;
-	for (iter=attr.begin(); iter != attr.end(); iter++) {
-		Sxmlattribute attrcopy = xmlattribute::create();
-		attrcopy->setName( (*iter)->getName());
-		attrcopy->setValue( (*iter)->getValue());
-		dst->add( attrcopy );
-	}
+	const vector<xmlattribute::slot>& attr = src->attributeSlots();
+	vector<xmlattribute::slot>::const_iterator iter;
+	for (iter=attr.begin(); iter != attr.end(); iter++)
+		dst->add( iter->name, iter->value );
 }
 
 //______________________________________________________________________________
@@ -40,20 +36,92 @@ Sxmlelement clonevisitor::copy (const Sxmlelement& src)
 {
 	Sxmlelement copy = xmlelement::create(src->getInputLineNumber());
 	if (copy) {
-		copy->setName( src->getName());
+		copy->setName( src->getInternedName());
 		copy->setValue( src->getValue());
+		copy->setOrder( src->getOrder());
 		copyAttributes (src, copy);
 	}
 	return copy;
 }
 
+//______________________________________________________________________________
+Sxmlelement& clonevisitor::lastCopy ()
+{
+	if (fShared && fStarted && fPending.size()) {
+		pending& p = fPending.back();
+		if (!p.copy) p.copy = copy (p.src);
+		fLastCopy = p.copy;
+	}
+	return fLastCopy;
+}
+
+//______________________________________________________________________________
+// adds a sub element to a pending element: the sub elements are only stored
+// once they differ from the source ones
+void clonevisitor::add (pending& p, const Sxmlelement& elt)
+{
+	const vector<Sxmlelement>& src = p.src->elements();
+	if (!p.diverged) {
+		if ((p.same < src.size()) && (src[p.same] == elt)) {
+			p.same++;
+			return;
+		}
+		p.diverged = true;
+		p.elements.assign (src.begin(), src.begin() + p.same);
+	}
+	p.elements.push_back (elt);
+}
+
+//______________________________________________________________________________
+void clonevisitor::sharedStart (const Sxmlelement& elt)
+{
+	pending p;
+	p.src = elt;
+	p.same = 0;
+	p.diverged = false;
+	fPending.push_back (p);
+	fLastCopy = Sxmlelement();
+	fStarted = true;
+}
+
+//______________________________________________________________________________
+// an unmodified element is shared, otherwise its copy gets the sub elements:
+// the copied ones become its own, the shared ones keep their parent link
+void clonevisitor::sharedEnd ()
+{
+	pending p = std::move (fPending.back());
+	fPending.pop_back();
+	fStarted = false;
+
+	Sxmlelement result = p.copy;
+	if (!result && (p.diverged || (p.same != p.src->elements().size())))
+		result = copy (p.src);
+	if (result) {
+		const vector<Sxmlelement>& elts = p.diverged ? p.elements : p.src->elements();
+		size_t n = p.diverged ? elts.size() : p.same;
+		for (size_t i = 0; i < n; i++) {
+			if (elts[i]->parent()) result->share (elts[i]);
+			else result->push (elts[i]);
+		}
+	}
+	else result = p.src;
+
+	if (fPending.empty()) fSharedClone = result;
+	else add (fPending.back(), result);
+}
+
 //______________________________________________________________________________
 void clonevisitor::visitStart ( Sxmlelement& elt )
 {
 	if (!fClone) return;
+	if (fShared) {
+		sharedStart (elt);
+		return;
+	}
 	Sxmlelement copy = xmlelement::create(elt->getInputLineNumber());
-	copy->setName( elt->getName());
+	copy->setName( elt->getInternedName());
 	copy->setValue( elt->getValue());
+	copy->setOrder( elt->getOrder());
 	copyAttributes (elt, copy);
 	fLastCopy = copy;
 	if (fStack.empty())
@@ -66,7 +134,8 @@ void clonevisitor::visitStart ( Sxmlelement& elt )
 void clonevisitor::visitEnd ( Sxmlelement& elt )
 {
 	if (!fClone) return;
-	if (!elt->empty()) fStack.pop();
+	if (fShared) sharedEnd ();
+	else if (!elt->empty()) fStack.pop();
 }
 
 }
@@ -14,6 +14,7 @@
 #define __cloneVisitor__
 
 #include <stack>
+#include <vector>
 #include "visitor.h"
 #include "xml.h"
 
@@ -27,28 +28,55 @@ namespace MusicXML2
 
 /*!
 \brief A visitor that clones a musicxml tree
+
+	In shared mode, the clone is copy-on-write: an element is copied only when
+	requested with lastCopy() (typically to be modified) or when its sub elements
+	differ from the source ones (sub elements copied, skipped or repeated).
+	The other subtrees are shared with the source tree, they keep their parent
+	link to the source tree and must not be modified. When nothing is modified,
+	clone() returns the source tree itself.
 */
 class EXP clonevisitor : 
 	public visitor<Sxmlelement>
 {
     public:
-				 clonevisitor() : fClone(true) {}
+				 clonevisitor(bool shared = false) : fClone(true), fShared(shared), fStarted(false) {}
        	virtual ~clonevisitor() {}
               
 		virtual void visitStart( Sxmlelement& elt );
 		virtual void visitEnd  ( Sxmlelement& elt );
 		
-		virtual Sxmlelement clone()	{ return fStack.top(); }
+		virtual Sxmlelement clone()	{ return fShared ? fSharedClone : fStack.top(); }
 
 	protected:
 		virtual void			clone(bool state)	{ fClone = state; }
 		virtual void			copyAttributes (const Sxmlelement& src, Sxmlelement& dst);
 		virtual Sxmlelement		copy (const Sxmlelement& elt);
-		virtual Sxmlelement&	lastCopy ()	{ return fLastCopy; }
+		//! the copy of the last visited element, in shared mode it must be called before the element end
+		virtual Sxmlelement&	lastCopy ();
 
 		bool					fClone;
 		Sxmlelement				fLastCopy;
 		std::stack<Sxmlelement> fStack;
+
+	private:
+		//! an element being cloned in shared mode
+		typedef struct {
+			Sxmlelement					src;
+			Sxmlelement					copy;		// the copy, when requested by lastCopy()
+			size_t						same;		// the count of leading sub elements identical to the source ones
+			bool						diverged;	// true when the sub elements differ from the source ones
+			std::vector<Sxmlelement>	elements;	// the sub elements, when diverged
+		} pending;
+
+		bool					fShared;
+		bool					fStarted;		// true when no element ended since the last visitStart
+		std::vector<pending>	fPending;
+		Sxmlelement				fSharedClone;
+
+		void	add (pending& p, const Sxmlelement& elt);
+		void	sharedStart (const Sxmlelement& elt);
+		void	sharedEnd ();
 };
 
 /*! @} */
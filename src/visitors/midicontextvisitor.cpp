@@ -85,24 +85,42 @@ midicontextvisitor::midicontextvisitor(long tpq, midiwriter* writer)
 	fTPQ = tpq;
 	fMidiWriter = writer;
 	fInBackup = fInForward = false;
-    fEndMeasureDate = 0;
+    fEndMeasureTicks = 0;
 	fEndPartDate = 0;
 
-    fCurrentDate = 0;
+    fCurrentTicks = fLastTicks = fPendingTicks = 0;
+    fCurrentDate = fPendingDuration = 0;
     fTranspose = 0;
 	fCurrentDynamics = 90;
 	fCurrentChan = 0;
 
-    fDivisions = 1; // to be checked
+    setDivisions (1); // to be checked
 }
 
 //________________________________________________________________________
-void midicontextvisitor::addDuration(long dur)
+// the time is tracked using the part timeline ticks, which are exact, and
+// converted to tpq for the midi writer. Without timeline (e.g. when the part
+// is not visited), the current division is used as tick.
+//________________________________________________________________________
+void midicontextvisitor::setDivisions(long divisions)
+{
+	fDivisions = divisions;
+	fTicksPerDivision = fTimeline ? fTimeline->ticksPerDivision (divisions) : 1;
+}
+
+long midicontextvisitor::ticks2Date(long ticks) const
+{
+	long tpq = fTimeline ? fTimeline->ticksPerQuarter() : fDivisions;
+	return long((ticks * (long long)fTPQ) / tpq);
+}
+
+//________________________________________________________________________
+void midicontextvisitor::addDuration(long ticks)
 {
-    // duration is expressed using the current division
-	fLastPosition = fCurrentDate;
-	fCurrentDate += dur;
-    fEndMeasureDate = max(fEndMeasureDate,fCurrentDate);
+	fLastTicks = fCurrentTicks;
+	fCurrentTicks += ticks;
+    fEndMeasureTicks = max(fEndMeasureTicks, fCurrentTicks);
+	fCurrentDate = ticks2Date (fCurrentTicks);
 }
 
 //________________________________________________________________________
@@ -151,7 +169,10 @@ void midicontextvisitor::playNote (const notevisitor& note)
 	}
 	if (note.isCue()) return;		// cue notes are ignored
 
-	long dur = convert2Tick(note.getDuration());
+	long ticks = note.getDuration() * fTicksPerDivision;
+	long start = note.inChord() ? fLastTicks : fCurrentTicks;
+	long date = ticks2Date (start);
+	long dur = ticks2Date (start + ticks) - date;
 
 	if (fMidiWriter && (t != notevisitor::kRest)) {
 		long chan = fCurrentChan;
@@ -175,7 +196,6 @@ void midicontextvisitor::playNote (const notevisitor& note)
 		if (vel == notevisitor::kUndefinedDynamics) vel = fCurrentDynamics;
 
 		int tie = note.getTie();
-		long date = note.inChord() ? fLastPosition : fCurrentDate;
 		if (note.isGrace()) {		// grace notes
 			dur = fTPQ / 6;			// have no duration - set to an arbitrary value
 			date -= dur;			// and play in advance
@@ -187,19 +207,21 @@ void midicontextvisitor::playNote (const notevisitor& note)
 		}
 		else if (tie & StartStop::start) {
 			fPendingDuration += dur;
+			fPendingTicks += ticks;
 			return;
 		}
 		else if (tie == StartStop::stop) {
 			dur += fPendingDuration;
+			ticks += fPendingTicks;
 			fMidiWriter->newNote(date, chan, note.getMidiPitch(), vel, dur);
-			fPendingDuration = 0;
+			fPendingDuration = fPendingTicks = 0;
 		}
 	}
 	// finally adjust the current date
 	if (note.isCue()) return;		// cue don't modify the current date
 	if (note.isGrace()) return;		// cue don't modify the current date
 	if (note.inChord()) return;		// we're in a chord and time has already advanced
-	addDuration (dur);
+	addDuration (ticks);
 }
 
 //________________________________________________________________________
@@ -220,7 +242,7 @@ void midicontextvisitor::playMidiInstrument (const midiInstrument& instr)
 //________________________________________________________________________
 void midicontextvisitor::visitStart( S_duration& elt )
 {
-    long dur = convert2Tick(long(*elt));
+    long dur = long(*elt) * fTicksPerDivision;
 	if (fInBackup)
 		addDuration( -dur);
 	else if (fInForward)
@@ -246,17 +268,19 @@ void midicontextvisitor::visitEnd ( S_midi_instrument& elt )
 }
 
 //________________________________________________________________________
-void midicontextvisitor::visitStart ( S_divisions& elt )	{ fDivisions = (long)(*elt); }
-void midicontextvisitor::visitEnd ( S_measure& elt )		{ fCurrentDate = fEndMeasureDate; }
+void midicontextvisitor::visitStart ( S_divisions& elt )	{ setDivisions ((long)(*elt)); }
+void midicontextvisitor::visitEnd ( S_measure& elt )		{ fCurrentTicks = fEndMeasureTicks; fCurrentDate = ticks2Date (fCurrentTicks); }
 void midicontextvisitor::visitEnd ( S_transpose& elt )		{ fTranspose = fChromatic + (fOctaveChange * 12); }
 
 //________________________________________________________________________
 void midicontextvisitor::visitStart ( S_part& elt )
 {
-    fCurrentDate = fLastPosition = fPendingDuration = 0;
-    fEndMeasureDate = fEndPartDate = 0;
+    fCurrentDate = fPendingDuration = 0;
+    fCurrentTicks = fLastTicks = fPendingTicks = 0;
+    fEndMeasureTicks = fEndPartDate = 0;
     fTranspose = 0;
-    fDivisions = 1;
+    fTimeline = parttimeline::create (elt);
+    setDivisions (1);
 
 	fCurrentPartID = elt->getAttributeValue("id");
 	int instrCount = fScoreInstruments.count(fCurrentPartID);
@@ -307,7 +331,7 @@ void midicontextvisitor::visitStart ( S_sound& elt )
 	if (attr) playPedalChange( midiwriter::kSostenutoPedal, attr->getValue() );
 
 	attr = elt->getAttribute("division");
-	if (attr) fDivisions = (long)(*attr);
+	if (attr) setDivisions ((long)(*attr));
 }
 
 }
@@ -19,6 +19,7 @@
 #include "typedefs.h"
 #include "visitor.h"
 #include "notevisitor.h"
+#include "parttimeline.h"
 #include "transposevisitor.h"
 
 namespace MusicXML2 
@@ -145,22 +146,27 @@ class EXP midicontextvisitor :
         bool	fInBackup;      // In backup state
         bool	fInForward;     // In forward state
         bool	fInSound;       // In sound element
-        long 	fEndMeasureDate;	// max of the date kept in a measure
+        long 	fEndMeasureTicks;	// max of the position kept in a measure
 		long	fEndPartDate;		// max of the part duration
    
     protected:
 		midiwriter*	fMidiWriter;
+		Sparttimeline fTimeline;		// the current part time base
  		long		fDivisions;			// current division
-        long		fCurrentDate;		// current date
-        long		fLastPosition;		// last time position (used for chord)
+		long		fTicksPerDivision;	// current division expressed in the timeline ticks
+		long		fCurrentTicks;		// current position in the timeline ticks
+		long		fLastTicks;			// last position in the timeline ticks (used for chord)
+        long		fCurrentDate;		// current date, maintained from fCurrentTicks
 		long		fPendingDuration;	// pending duration (used for tied notes)
+		long		fPendingTicks;		// pending duration in the timeline ticks
         long		fCurrentDynamics;	// current dynamics ie MIDI velocity
         long		fTranspose;			// current transpose value
 		long		fTPQ;				// ticks-per-quater value for date conversion
         long		fCurrentChan;		// current midi channel
 		
-        void addDuration(long dur);		// move the current time, dur must be expressed in tpq
-  		long convert2Tick(long val) { return (val*fTPQ)/fDivisions; }
+        void addDuration(long ticks);	// move the current time, expressed in the timeline ticks
+		void setDivisions(long divisions);
+		long ticks2Date(long ticks) const;	// converts the timeline ticks to tpq
   		long convert2Vel(long val)	{ return  (val * 90) / 100; }
 
  		virtual void playScoreInstrument (const scoreInstrument& instr);
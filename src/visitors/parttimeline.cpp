@@ -0,0 +1,87 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifdef MSVC
+# pragma warning (disable : 4786)
+#endif
+
+#include "elements.h"
+#include "parttimeline.h"
+
+using namespace std;
+
+namespace MusicXML2
+{
+
+//______________________________________________________________________________
+Sparttimeline parttimeline::create (const S_part& part)
+{
+	parttimeline* o = new parttimeline(part); assert(o!=0);
+	return o;
+}
+
+//______________________________________________________________________________
+parttimeline::parttimeline (const S_part& part) : fPart(part), fTicksPerQuarter(1)
+{
+	if (part) scale (part);
+}
+
+//______________________________________________________________________________
+// the divisions value of an attributes element, 0 when missing
+static long elementDivisions (const xmlelement* attributes)
+{
+	for (ctree<xmlelement>::branchs::const_iterator i = attributes->elements().begin(); i != attributes->elements().end(); i++) {
+		if ((*i)->getType() == k_divisions) return long(**i);
+	}
+	return 0;
+}
+
+//______________________________________________________________________________
+static long gcd (long a, long b)
+{
+	while (b) { long r = a % b; a = b; b = r; }
+	return a;
+}
+
+//______________________________________________________________________________
+// the ticks per quarter is the least common multiple of the divisions values
+void parttimeline::scale (const S_part& part)
+{
+	long lcm = 1;
+	for (ctree<xmlelement>::literator m = part->elements().begin(); m != part->elements().end(); m++) {
+		if ((*m)->getType() != k_measure) continue;
+		for (ctree<xmlelement>::literator i = (*m)->elements().begin(); i != (*m)->elements().end(); i++) {
+			if ((*i)->getType() != k_attributes) continue;
+			long d = elementDivisions (*i);
+			if (d > 0) lcm = (lcm / gcd (lcm, d)) * d;
+		}
+	}
+	fTicksPerQuarter = lcm;
+}
+
+//______________________________________________________________________________
+long parttimeline::ticksPerDivision (long divisions) const
+{
+	if (divisions <= 0) return fTicksPerQuarter;
+	long tpd = fTicksPerQuarter / divisions;
+	return tpd ? tpd : 1;				// a divisions value unknown to the timeline
+}
+
+//______________________________________________________________________________
+rational parttimeline::wholeNotes (long ticks) const
+{
+	rational r (ticks, fTicksPerQuarter * 4);
+	r.rationalise();
+	return r;
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+  MusicXML Library
+  Copyright (C) Grame 2006-2013
+
+  This Source Code Form is subject to the terms of the Mozilla Public
+  License, v. 2.0. If a copy of the MPL was not distributed with this
+  file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+  Grame Research Laboratory, 11, cours de Verdun Gensoul 69002 Lyon - France
+  research@grame.fr
+*/
+
+#ifndef __parttimeline__
+#define __parttimeline__
+
+#include "exports.h"
+#include "rational.h"
+#include "smartpointer.h"
+#include "typedefs.h"
+#include "xml.h"
+
+namespace MusicXML2
+{
+
+/*!
+\addtogroup visitors
+@{
+*/
+
+//______________________________________________________________________________
+/*!
+\brief an integer time base for a part.
+
+	The tick unit is chosen so that any duration of the part is an integer count of ticks:
+	the count of ticks per quarter note is the least common multiple of all the \c divisions
+	values of the part, computed by a single pass over the part attributes.
+	Note that the tuplets ratios are already part of the durations expressed in divisions.
+
+	The converters may thus track the time using integer arithmetic, the ticks are converted
+	to rationals (see wholeNotes) only when needed.
+*/
+class EXP parttimeline : public smartable
+{
+	public:
+		//! computes the time base of the part \c part
+		static SMARTP<parttimeline> create (const S_part& part);
+
+		//! the part described by the timeline
+		const Sxmlelement&	part () const				{ return fPart; }
+		//! the count of ticks per quarter note
+		long		ticksPerQuarter () const			{ return fTicksPerQuarter; }
+		//! the count of ticks per division, for a given \c divisions value
+		long		ticksPerDivision (long divisions) const;
+		//! converts a tick count to a rational expressed in whole notes (normalized)
+		rational	wholeNotes (long ticks) const;
+
+	protected:
+				 parttimeline (const S_part& part);
+		virtual ~parttimeline() {}
+
+	private:
+		Sxmlelement			fPart;
+		long				fTicksPerQuarter;
+
+		void	scale (const S_part& part);
+};
+typedef SMARTP<parttimeline> Sparttimeline;
+
+/*! @} */
+
+}
+
+#endif
@@ -28,6 +28,9 @@ namespace MusicXML2
 //______________________________________________________________________________
 /*!
 \brief A visitor that creates an "unrolled" version of a score.
+
+	In shared mode (see clonevisitor), the parts and the measures are copied,
+	the measures content is shared with the source score.
 */
 class EXP unrolled_clonevisitor : public clonevisitor,
 	public visitor<S_measure>,
@@ -48,7 +51,7 @@ class EXP unrolled_clonevisitor : public clonevisitor,
 		virtual void start (Sxmlelement elt)	{ clonevisitor::visitStart(elt); }
 		virtual void end (Sxmlelement elt)		{ clonevisitor::visitEnd(elt); }
 	public:
-				 unrolled_clonevisitor() : fMeasureNum(1) {}
+				 unrolled_clonevisitor(bool shared = false) : clonevisitor(shared), fMeasureNum(1) {}
 		virtual ~unrolled_clonevisitor() {}
 
 		virtual void visitStart( S_measure& elt);
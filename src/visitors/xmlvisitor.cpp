@@ -11,6 +11,7 @@
 */
 
 #include <iostream>
+#include "xmlescape.h"
 #include "xmlvisitor.h"
 
 using namespace std;
@@ -32,6 +33,19 @@ void xmlendl::print(std::ostream& os) const {
     while (i-- > 0)  os << "    ";
 }
 
+//______________________________________________________________________________
+// writes a value, escaping the xml special characters
+static void escaped (ostream& os, const string& value, bool attribute)
+{
+	if (xmlescape::find (value.data(), value.size(), attribute) == value.size())
+		os << value;
+	else {
+		string s;
+		xmlescape::append (s, value.data(), value.size(), attribute);
+		os << s;
+	}
+}
+
 //______________________________________________________________________________
 void xmlvisitor::visitStart ( S_comment& elt ) 
 {
@@ -49,16 +63,19 @@ void xmlvisitor::visitStart ( Sxmlelement& elt )
 {
 	fOut <<  fendl << "<" << elt->getName();
 	// print the element attributes first
-	vector<Sxmlattribute>::const_iterator attr; 
-	for (attr = elt->attributes().begin(); attr != elt->attributes().end(); attr++)
-		fOut << " " << (*attr)->getName() << "=\"" << (*attr)->getValue() << "\"";				
+	vector<xmlattribute::slot>::const_iterator attr; 
+	for (attr = elt->attributeSlots().begin(); attr != elt->attributeSlots().end(); attr++) {
+		fOut << " " << *attr->name << "=\"";
+		escaped (fOut, attr->value, true);
+		fOut << "\"";
+	}
 	if (elt->empty()) {
 		fOut << "/>";	// element is empty, we can direclty close it
 	}
 	else {
 		fOut << ">";
 		if (!elt->getValue().empty())
-			fOut << elt->getValue();
+			escaped (fOut, elt->getValue(), false);
 		if (elt->size())
 			fendl++;
 	}